@@ -0,0 +1,48 @@
+/*
+Copyright 2017 Bert Burgemeister <trebbu@googlemail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Section markers for the simavr benchmark (bench/bench.c), which
+ * watches GPIOR0 and counts the cycles between a section's start and
+ * end markers.  A marker costs a cycle or two; without BENCH from
+ * config.h there are none.
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+/* keep in sync with section_names in bench/bench.c */
+enum bench_section {
+    BENCH_SCAN,                 /* matrix_scan() */
+    BENCH_DECODE,               /* action_function(), emitting included */
+    BENCH_EMIT,                 /* a committed chord */
+    BENCH_LEDS,                 /* LED task */
+    BENCH_EEPROM,               /* writing a byte */
+    BENCH_REPORT,               /* report sent; not counted in the above */
+    BENCH_SECTIONS
+};
+
+#if BENCH
+#include <avr/io.h>
+#define bench_start(section) (GPIOR0 = 2 * (section) + 1)
+#define bench_end(section) (GPIOR0 = 2 * (section) + 2)
+#else
+#define bench_start(section)
+#define bench_end(section)
+#endif
+
+#endif
@@ -0,0 +1,257 @@
+/*
+Copyright 2017 Bert Burgemeister <trebbu@googlemail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Run the firmware's ELF file under simavr, press and release keys as
+ * told by a key script on stdin (the format of host/main.c), and print
+ * a tab-separated table of the cycles spent in the sections marked by
+ * bench.h, and of the cycles from the first key press of a chord to
+ * its first report.  Needs a firmware built with BENCH.
+ *
+ * LUFA waits for the USB host before it starts the keyboard, so with
+ * -u the address of USB_DeviceState is held at "configured".  There's
+ * no USB host.  Cycles spent sending a report are left out of the
+ * sections around it, so these show the keymap's own work; chord
+ * latency runs up to the start of the first report.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "sim_avr.h"
+#include "sim_elf.h"
+#include "sim_io.h"
+#include "avr_ioport.h"
+#include "../bench.h"
+
+
+#define GPIOR0_ADDR 0x3e
+#define DEVICE_STATE_CONFIGURED 4
+#define ROWS 4
+#define COLS 4
+
+static const char *const section_names[BENCH_SECTIONS] = {
+    [BENCH_SCAN] = "scan",
+    [BENCH_DECODE] = "decode",
+    [BENCH_EMIT] = "emit",
+    [BENCH_LEDS] = "leds",
+    [BENCH_EEPROM] = "eeprom",
+    [BENCH_REPORT] = "report",
+};
+
+/* as in matrix.c */
+static const struct {
+    char port;
+    uint8_t pin;
+} row_pins[ROWS] = {{'B', 3}, {'B', 2}, {'D', 3}, {'C', 2}},
+    col_pins[COLS] = {{'C', 7}, {'C', 4}, {'D', 2}, {'D', 1}};
+
+typedef struct {
+    uint32_t n;
+    avr_cycle_count_t min, max, sum;
+} stat_t;
+
+static avr_t *avr;
+static avr_irq_t *row_irqs[ROWS];
+static uint8_t pressed[ROWS];   /* per row, columns of pressed keys */
+static uint8_t cols_low;        /* columns selected by the firmware */
+static avr_cycle_count_t started[BENCH_SECTIONS], chrd_start;
+static avr_cycle_count_t reporting, reporting_at[BENCH_SECTIONS];
+static bool chrd_pending;
+static stat_t stats[BENCH_SECTIONS], latency;
+
+static void
+add(stat_t *s, avr_cycle_count_t cycles)
+{
+    if (!s->n || cycles < s->min)
+        s->min = cycles;
+    if (cycles > s->max)
+        s->max = cycles;
+    s->sum += cycles;
+    s->n++;
+}
+
+/*
+ * A row reads low while a pressed key connects it to a selected
+ * column
+ */
+static void
+update_rows(void)
+{
+    uint8_t r;
+
+    for (r = 0; r < ROWS; r++)
+        avr_raise_irq(row_irqs[r], !(pressed[r] & cols_low));
+}
+
+static void
+col_changed(struct avr_irq_t *irq, uint32_t value, void *param)
+{
+    uint8_t col = (uintptr_t)param;
+
+    if (value)
+        cols_low &= ~(1<<col);
+    else
+        cols_low |= 1<<col;
+    update_rows();
+}
+
+static void
+gpior0_written(struct avr_t *avr, avr_io_addr_t addr, uint8_t v, void *param)
+{
+    uint8_t section = (v - 1) / 2;
+    avr_cycle_count_t cycles;
+
+    avr->data[addr] = v;
+    if (!v || section >= BENCH_SECTIONS)
+        return;
+    if (v & 1) {
+        started[section] = avr->cycle;
+        reporting_at[section] = reporting;
+        if (section == BENCH_REPORT && chrd_pending) {
+            add(&latency, avr->cycle - chrd_start);
+            chrd_pending = false;
+        }
+        return;
+    }
+    cycles = avr->cycle - started[section] - (reporting - reporting_at[section]);
+    add(&stats[section], cycles);
+    if (section == BENCH_REPORT)
+        reporting += cycles;
+}
+
+static void
+key(uint8_t row, uint8_t col, bool down)
+{
+    uint8_t r, any = 0;
+
+    for (r = 0; r < ROWS; r++)
+        any |= pressed[r];
+    if (down) {
+        if (!any) {
+            chrd_start = avr->cycle;
+            chrd_pending = true;
+        }
+        pressed[row] |= 1<<col;
+    } else {
+        pressed[row] &= ~(1<<col);
+    }
+    update_rows();
+}
+
+static void
+run_until(avr_cycle_count_t cycle, uint16_t usb_state)
+{
+    int state;
+
+    while (avr->cycle < cycle) {
+        if (usb_state && avr->data[usb_state] != DEVICE_STATE_CONFIGURED)
+            avr->data[usb_state] = DEVICE_STATE_CONFIGURED;
+        state = avr_run(avr);
+        if (state == cpu_Done || state == cpu_Crashed) {
+            fprintf(stderr, "firmware stopped at cycle %llu\n",
+                    (unsigned long long)avr->cycle);
+            exit(1);
+        }
+    }
+}
+
+static void
+print_stat(const char *name, const stat_t *s)
+{
+    printf("%s\t%u\t%llu\t%llu\t%llu\n", name, s->n,
+           (unsigned long long)s->min,
+           (unsigned long long)(s->n ? s->sum / s->n : 0),
+           (unsigned long long)s->max);
+}
+
+static void
+usage(const char *name)
+{
+    fprintf(stderr, "usage: %s [-m mcu] [-f hz] [-u usb_state_addr] firmware.elf < script\n",
+            name);
+    exit(2);
+}
+
+int
+main(int argc, char **argv)
+{
+    const char *mcu = "atmega32u2";
+    uint32_t freq = 16000000;
+    uint16_t usb_state = 0;
+    elf_firmware_t f = {{0}};
+    char line[100], cmd, *p;
+    unsigned int a, b;
+    double t;
+    int opt, i;
+
+    while ((opt = getopt(argc, argv, "m:f:u:")) != -1)
+        switch (opt) {
+        case 'm':
+            mcu = optarg;
+            break;
+        case 'f':
+            freq = strtoul(optarg, NULL, 0);
+            break;
+        case 'u':
+            usb_state = strtoul(optarg, NULL, 0) & 0xffff; /* avr-nm says 0x80xxxx */
+            break;
+        default:
+            usage(argv[0]);
+        }
+    if (optind != argc - 1)
+        usage(argv[0]);
+    if (elf_read_firmware(argv[optind], &f)) {
+        fprintf(stderr, "%s: can't read\n", argv[optind]);
+        return 1;
+    }
+    if (!(avr = avr_make_mcu_by_name(mcu))) {
+        fprintf(stderr, "%s: no such core in simavr\n", mcu);
+        return 1;
+    }
+    f.frequency = freq;
+    avr_init(avr);
+    avr_load_firmware(avr, &f);
+    for (i = 0; i < ROWS; i++) {
+        row_irqs[i] = avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ(row_pins[i].port),
+                                    row_pins[i].pin);
+        avr_raise_irq(row_irqs[i], 1);
+    }
+    for (i = 0; i < COLS; i++)
+        avr_irq_register_notify(avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ(col_pins[i].port),
+                                              col_pins[i].pin),
+                                col_changed, (void *)(uintptr_t)i);
+    avr_register_io_write(avr, GPIOR0_ADDR, gpior0_written, NULL);
+    while (fgets(line, sizeof(line), stdin)) {
+        t = strtod(line, &p);
+        if (p != line)
+            run_until(t * (freq / 1000), usb_state);
+        if (sscanf(p, " %c", &cmd) != 1 || cmd == '#')
+            continue;
+        if ((cmd == 'd' || cmd == 'u') && sscanf(p, " %c %u %u", &cmd, &a, &b) == 3
+            && a < ROWS && b < COLS)
+            key(a, b, cmd == 'd');
+        else if (cmd == 'w' && p == line && sscanf(p, " %c %u", &cmd, &a) == 2)
+            run_until(avr->cycle + (avr_cycle_count_t)a * (freq / 1000), usb_state);
+    }
+    printf("section\tn\tmin\tavg\tmax\n");
+    for (i = 0; i < BENCH_SECTIONS; i++)
+        print_stat(section_names[i], &stats[i]);
+    print_stat("latency", &latency);
+    return 0;
+}
@@ -255,6 +255,8 @@ type (
 		legendIsChar     bool
 		modifiers        []string
 		modifierDuration string
+		hold             bool
+		first            int // 1 + column to be pressed first; 0 if any
 		header           string
 		headerStyle      string
 		suppressQ        bool
@@ -414,6 +416,15 @@ func (cm *chordMap) chordPad(cp chordPad) bool {
 			}
 		}
 	}
+	if cp.first > 0 {
+		col := cp.first - 1
+		for row := 1; row < 4; row++ {
+			if cp.chord[row][col] {
+				cm.canvas.Circle(cm.x+col*(keySize+keySep)+keySize/2,
+					cm.y+(row-1)*(keySize+keySep)+keySize/2, keySize/5, "fill:white")
+			}
+		}
+	}
 	if !cp.suppressQ {
 		cm.canvas.Text(cm.x+padSize+keySep, cm.y+padSize+keySep,
 			fmt.Sprintf("%d", cp.chord.quality()), qStyle+
@@ -492,6 +503,11 @@ func main() {
 				cpLo.chord[row][col] = true
 				cpUp.chord[row][col] = true
 			}
+			if r[1] != ' ' {
+				first, _ := strconv.Atoi(string(r[1]))
+				cpLo.first = first + 1
+				cpUp.first = first + 1
+			}
 			if r[16] != ' ' {
 				cpLo.legend = string(r[16])
 				cpLo.legendIsChar = true
@@ -524,6 +540,7 @@ func main() {
 			if len(cp.legend) == 0 {
 				cp.legend = "DUMMY"
 			}
+			cp.hold = r[17] == 'h'
 			chordPads = append(chordPads, cp)
 
 		} else if len(r) > 25 && r[0] == '*' {
@@ -589,6 +606,9 @@ func main() {
 		l, ok := specialKeys[cp.legend]
 		if ok {
 			cp.legend = l
+			if cp.hold {
+				cp.legend = "hold " + l
+			}
 			cm.put(cp)
 		} else if cp.legendIsChar {
 			cm.put(cp)
@@ -47,6 +47,7 @@ const (
 	frameStyle            = "stroke:lightgrey;fill:white"
 	keyStyle              = "stroke:lightgrey;stroke-width:30;fill:white"
 	bsUnit                = 3
+	maxLevel              = 15 // LED brightness from fade curves
 	redColor              = "crimson"
 	greenColor            = "limeGreen"
 	offColor              = "whitesmoke"
@@ -59,7 +60,10 @@ const (
 )
 
 type (
-	bp  struct{ on, off, cycles int }
+	bp struct {
+		on, off, cycles int
+		fade            string
+	}
 	ls  struct{ leds, bp string }
 	led struct {
 		x, y  int
@@ -68,6 +72,7 @@ type (
 	}
 	ledSets       map[string][]int
 	blinkPatterns map[string]bp
+	fadeCurves    map[string][]int
 	ledSignals    map[string]ls
 	blinkOnLine   struct{ x0, x1 int }
 	ledSignalMap  struct {
@@ -78,6 +83,7 @@ type (
 		yPageOffset   int
 		ledSets       ledSets
 		blinkPatterns blinkPatterns
+		fadeCurves    fadeCurves
 		ledSignals    ledSignals
 	}
 )
@@ -106,11 +112,13 @@ func main() {
 	flag.Parse()
 	ledSetRx := regexp.MustCompile(` *\[LEDS_([A-Z_]+)\] *= \{\.len.+\{([0-9, ]+)\}\},`)
 	ledSetLedsRx := regexp.MustCompile(`([0-9]+)[, ]*`)
-	blinkPatternRx := regexp.MustCompile(`^#define BLINK_([A-Z_]+) ([0-9]+), ([0-9]+), ([0-9A-Z]+)`)
+	blinkPatternRx := regexp.MustCompile(`^#define BLINK_([A-Z_]+) ([0-9]+), ([0-9]+), ([0-9A-Z]+)(?:, FADE_([A-Z_]+))?`)
+	fadeCurveRx := regexp.MustCompile(` *\[FADE_([A-Z_]+)\] *= \{([0-9, ]+)\},`)
 	ledSignalRx := regexp.MustCompile(`^#define [A-Z_]+_ON LEDS_([A-Z_]+), BLINK_([A-Z_]+) .*/\* (.*) \*/`)
 	lsm.xPads = (100**width - 2*pageMargin + padSep) / (padSize + padSep)
 	lsm.ledSets = make(ledSets)
 	lsm.blinkPatterns = make(blinkPatterns)
+	lsm.fadeCurves = make(fadeCurves)
 	lsm.ledSignals = make(ledSignals)
 	inFilename := "../nan-15_chord.c"
 	inFile, err := os.Open(inFilename)
@@ -124,6 +132,7 @@ func main() {
 		ledSet := ledSetRx.FindStringSubmatch(r)
 		blinkPattern := blinkPatternRx.FindStringSubmatch(r)
 		ledSignal := ledSignalRx.FindStringSubmatch(r)
+		fadeCurve := fadeCurveRx.FindStringSubmatch(r)
 		if len(ledSet) > 0 {
 			var leds []int
 			for _, l := range ledSetLedsRx.FindAllStringSubmatch(ledSet[2], -1) {
@@ -140,8 +149,17 @@ func main() {
 			if err != nil {
 				p.cycles = -1
 			}
+			p.fade = blinkPattern[5]
 			lsm.blinkPatterns[blinkPattern[1]] = p
 		}
+		if len(fadeCurve) > 0 {
+			var levels []int
+			for _, l := range ledSetLedsRx.FindAllStringSubmatch(fadeCurve[2], -1) {
+				level, _ := strconv.Atoi(l[1])
+				levels = append(levels, level)
+			}
+			lsm.fadeCurves[fadeCurve[1]] = levels
+		}
 		if len(ledSignal) > 0 {
 			lsm.ledSignals[ledSignal[3]] = ls{leds: ledSignal[1], bp: ledSignal[2]}
 		}
@@ -217,13 +235,24 @@ func (lsm *ledSignalMap) putLs(legend string, l ls) {
 	lsm.canvas.Text(x+padSize/2, y-frameThickness-(legendHeight/2), legend,
 		legendStyle)
 	if ok {
+		levels := lsm.fadeCurves[lsm.blinkPatterns[l.bp].fade]
+		if len(levels) == 0 {
+			levels = []int{maxLevel}
+		}
 		for _, bol := range bs {
 			xStart = xFrame + bol.x0
 			xEnd = xFrame + bol.x1
-			lsm.canvas.Line(xStart, yUpper, xEnd, yUpper,
-				fmt.Sprintf("stroke:%s;stroke-width:%d", ledColor1, blinkPatternThickness))
-			lsm.canvas.Line(xStart, yLower, xEnd, yLower,
-				fmt.Sprintf("stroke:%s;stroke-width:%d", ledColor2, blinkPatternThickness))
+			for i, level := range levels {
+				x0 := xStart + (xEnd-xStart)*i/len(levels)
+				x1 := xStart + (xEnd-xStart)*(i+1)/len(levels)
+				opacity := float64(level) / maxLevel
+				lsm.canvas.Line(x0, yUpper, x1, yUpper,
+					fmt.Sprintf("stroke:%s;stroke-width:%d;stroke-opacity:%.2f",
+						ledColor1, blinkPatternThickness, opacity))
+				lsm.canvas.Line(x0, yLower, x1, yLower,
+					fmt.Sprintf("stroke:%s;stroke-width:%d;stroke-opacity:%.2f",
+						ledColor2, blinkPatternThickness, opacity))
+			}
 		}
 	}
 	if lsm.blinkPatterns[l.bp].cycles == -1 {
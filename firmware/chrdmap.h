@@ -0,0 +1,277 @@
+/*
+Copyright 2017 Bert Burgemeister <trebbu@googlemail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Initializer of nan-15_chord.c's chrdmap in EEPROM, and of chordmap
+ * profile 1 in flash if CHRDMAP_PROFILES > 1
+ */
+    [CHRD(0, 0, 0, 0)] = KEYPAIR(   No, NO,             Sh, NO            ),
+    [CHRD(0, 0, 0, 1)] = KEYPAIR(   No, 1,              No, F1            ),
+    [CHRD(0, 0, 0, 2)] = KEYPAIR(   No, 0,              No, F10           ),
+    [CHRD(0, 0, 0, 3)] = KEYPAIR(   No, DOT,            Sh, DOT           ),
+    [CHRD(0, 0, 1, 0)] = KEYPAIR(   No, 2,              No, F2            ),
+    [CHRD(0, 0, 1, 1)] = KEYPAIR(   No, 3,              No, F3            ),
+    [CHRD(0, 0, 1, 2)] = KEYPAIR(   No, Q,              Sh, Q             ),
+    [CHRD(0, 0, 1, 3)] = KEYPAIR(   No, FN4,            No, NO            ),
+    [CHRD(0, 0, 2, 0)] = KEYPAIR(   No, I,              Sh, I             ),
+    [CHRD(0, 0, 2, 1)] = KEYPAIR(   No, Z,              Sh, Z             ),
+    [CHRD(0, 0, 2, 2)] = KEYPAIR(   No, T,              Sh, T             ),
+    [CHRD(0, 0, 2, 3)] = KEYPAIR(   Ag, EQUAL,       Ag|Sh, EQUAL         ),
+    [CHRD(0, 0, 3, 0)] = KEYPAIR(   No, COMMA,          Sh, COMMA         ),
+    [CHRD(0, 0, 3, 1)] = KEYPAIR(   No, FN5,            No, NO            ),
+    [CHRD(0, 0, 3, 2)] = KEYPAIR(   Ag, 7,              Ag, 0             ),
+    [CHRD(0, 0, 3, 3)] = KEYPAIR(   Sh, MINUS,          Sh, 1             ),
+    [CHRD(0, 1, 0, 0)] = KEYPAIR(   No, 4,              No, F4            ),
+    [CHRD(0, 1, 0, 1)] = KEYPAIR(   No, 5,              No, F5            ),
+    [CHRD(0, 1, 0, 2)] = KEYPAIR(   No, UNDO,           No, HELP          ),
+    [CHRD(0, 1, 0, 3)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(0, 1, 1, 0)] = KEYPAIR(   No, 6,              No, F6            ),
+    [CHRD(0, 1, 1, 1)] = KEYPAIR(   No, 7,              No, F7            ),
+    [CHRD(0, 1, 1, 2)] = KEYPAIR(   No, LANG4,          No, INT4          ),
+    [CHRD(0, 1, 1, 3)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(0, 1, 2, 0)] = KEYPAIR(   No, X,              Sh, X             ),
+    [CHRD(0, 1, 2, 1)] = KEYPAIR(   No, KP_ENTER,       No, NO            ),
+    [CHRD(0, 1, 2, 2)] = KEYPAIR(   Ag, LBRACKET,    Ag|Sh, SCOLON        ),
+    [CHRD(0, 1, 2, 3)] = KEYPAIR(   No, KP_6,           No, NO            ),
+    [CHRD(0, 1, 3, 0)] = KEYPAIR(   No, FN2,            No, NO            ),
+    [CHRD(0, 1, 3, 1)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(0, 1, 3, 2)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(0, 1, 3, 3)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(0, 2, 0, 0)] = KEYPAIR(   No, E,              Sh, E             ),
+    [CHRD(0, 2, 0, 1)] = KEYPAIR(   No, GRAVE,          Sh, GRAVE         ),
+    [CHRD(0, 2, 0, 2)] = KEYPAIR(   No, R,              Sh, R             ),
+    [CHRD(0, 2, 0, 3)] = KEYPAIR(   No, QUOTE,          Sh, QUOTE         ),
+    [CHRD(0, 2, 1, 0)] = KEYPAIR(   No, K,              Sh, K             ),
+    [CHRD(0, 2, 1, 1)] = KEYPAIR(   Ag|Sh, 9,        Ag|Sh, 8             ),
+    [CHRD(0, 2, 1, 2)] = KEYPAIR(   No, ESCAPE,         No, PASTE         ),
+    [CHRD(0, 2, 1, 3)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(0, 2, 2, 0)] = KEYPAIR(   No, S,              Sh, S             ),
+    [CHRD(0, 2, 2, 1)] = KEYPAIR(   Ag, 2,           Ag|Sh, 2             ),
+    [CHRD(0, 2, 2, 2)] = KEYPAIR(   No, G,              Sh, G             ),
+    [CHRD(0, 2, 2, 3)] = KEYPAIR(   No, RIGHT,          No, LEFT          ),
+    [CHRD(0, 2, 3, 0)] = KEYPAIR(   Ag, D,           Ag|Sh, D             ),
+    [CHRD(0, 2, 3, 1)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(0, 2, 3, 2)] = KEYPAIR(   No, BSLASH,         Sh, BSLASH        ),
+    [CHRD(0, 2, 3, 3)] = KEYPAIR(   Ag, 5,           Ag|Sh, 5             ),
+    [CHRD(0, 3, 0, 0)] = KEYPAIR(   Sh, 4,              Sh, 3             ),
+    [CHRD(0, 3, 0, 1)] = KEYPAIR(   No, KP_EQUAL,       No, NO            ),
+    [CHRD(0, 3, 0, 2)] = KEYPAIR(   No, KP_DOT,         No, NO            ),
+    [CHRD(0, 3, 0, 3)] = KEYPAIR(   No, SLASH,          Sh, SLASH         ),
+    [CHRD(0, 3, 1, 0)] = KEYPAIR(   No, FN3,            No, NO            ),
+    [CHRD(0, 3, 1, 1)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(0, 3, 1, 2)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(0, 3, 1, 3)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(0, 3, 2, 0)] = KEYPAIR(   Ag, 8,              Ag, 9             ),
+    [CHRD(0, 3, 2, 1)] = KEYPAIR(   No, KP_9,           No, NO            ),
+    [CHRD(0, 3, 2, 2)] = KEYPAIR(   Ag|Sh, COMMA,    Ag|Sh, DOT           ),
+    [CHRD(0, 3, 2, 3)] = KEYPAIR(   No, UP,             No, DOWN          ),
+    [CHRD(0, 3, 3, 0)] = KEYPAIR(   No, SPACE,          No, NO            ),
+    [CHRD(0, 3, 3, 1)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(0, 3, 3, 2)] = KEYPAIR(   Ag, T,           Ag|Sh, T             ),
+    [CHRD(0, 3, 3, 3)] = KEYPAIR(   Sh, 7,              Ag, MINUS         ),
+    [CHRD(1, 0, 0, 0)] = KEYPAIR(   No, 8,              No, F8            ),
+    [CHRD(1, 0, 0, 1)] = KEYPAIR(   No, 9,              No, F9            ),
+    [CHRD(1, 0, 0, 2)] = KEYPAIR(   No, F11,            No, F12           ),
+    [CHRD(1, 0, 0, 3)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(1, 0, 1, 0)] = KEYPAIR(   No, P,              Sh, P             ),
+    [CHRD(1, 0, 1, 1)] = KEYPAIR(   No, D,              Sh, D             ),
+    [CHRD(1, 0, 1, 2)] = KEYPAIR(   Ag, X,              Ag, Z             ),
+    [CHRD(1, 0, 1, 3)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(1, 0, 2, 0)] = KEYPAIR(   No, MINUS,          No, NO            ),
+    [CHRD(1, 0, 2, 1)] = KEYPAIR(   Ag, SLASH,       Ag|Sh, SLASH         ),
+    [CHRD(1, 0, 2, 2)] = KEYPAIR(   Ag, U,           Ag|Sh, U             ),
+    [CHRD(1, 0, 2, 3)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(1, 0, 3, 0)] = KEYPAIR(   No, FN6,            No, NO            ),
+    [CHRD(1, 0, 3, 1)] = KEYPAIR(   Ag, BSLASH,         No, NO            ),
+    [CHRD(1, 0, 3, 2)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(1, 0, 3, 3)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(1, 1, 0, 0)] = KEYPAIR(   No, C,              Sh, C             ),
+    [CHRD(1, 1, 0, 1)] = KEYPAIR(   No, B,              Sh, B             ),
+    [CHRD(1, 1, 0, 2)] = KEYPAIR(   No, KP_ASTERISK,    No, NO            ),
+    [CHRD(1, 1, 0, 3)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(1, 1, 1, 0)] = KEYPAIR(   No, W,              Sh, W             ),
+    [CHRD(1, 1, 1, 1)] = KEYPAIR(   No, Y,              Sh, Y             ),
+    [CHRD(1, 1, 1, 2)] = KEYPAIR(   No, KP_1,           No, NO            ),
+    [CHRD(1, 1, 1, 3)] = KEYPAIR(   No, NO,          Ag|Sh, E             ),
+    [CHRD(1, 1, 2, 0)] = KEYPAIR(   No, KP_3,           No, NO            ),
+    [CHRD(1, 1, 2, 1)] = KEYPAIR(   No, KP_4,           No, NO            ),
+    [CHRD(1, 1, 2, 2)] = KEYPAIR(   No, KP_5,           No, NO            ),
+    [CHRD(1, 1, 2, 3)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(1, 1, 3, 0)] = KEYPAIR(   No, KP_7,           No, NO            ),
+    [CHRD(1, 1, 3, 1)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(1, 1, 3, 2)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(1, 1, 3, 3)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(1, 2, 0, 0)] = KEYPAIR(   No, V,              Sh, V             ),
+    [CHRD(1, 2, 0, 1)] = KEYPAIR(   Ag, NONUS_HASH,  Ag|Sh, NONUS_HASH    ),
+    [CHRD(1, 2, 0, 2)] = KEYPAIR(   No, APPLICATION,    No, NO            ),
+    [CHRD(1, 2, 0, 3)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(1, 2, 1, 0)] = KEYPAIR(Ag|Sh, X,           Ag|Sh, Z             ),
+    [CHRD(1, 2, 1, 1)] = KEYPAIR(   No, F13,            No, F14           ),
+    [CHRD(1, 2, 1, 2)] = KEYPAIR(   No, F15,            No, F16           ),
+    [CHRD(1, 2, 1, 3)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(1, 2, 2, 0)] = KEYPAIR(   Ag, Y,              Ag, I             ),
+    [CHRD(1, 2, 2, 1)] = KEYPAIR(   No, F17,            No, F18           ),
+    [CHRD(1, 2, 2, 2)] = KEYPAIR(   No, F19,            No, F20           ),
+    [CHRD(1, 2, 2, 3)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(1, 2, 3, 0)] = KEYPAIR(   No, F21,            No, F22           ),
+    [CHRD(1, 2, 3, 1)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(1, 2, 3, 2)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(1, 2, 3, 3)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(1, 3, 0, 0)] = KEYPAIR(   No, FN0,            No, NO            ),
+    [CHRD(1, 3, 0, 1)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(1, 3, 0, 2)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(1, 3, 0, 3)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(1, 3, 1, 0)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(1, 3, 1, 1)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(1, 3, 1, 2)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(1, 3, 1, 3)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(1, 3, 2, 0)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(1, 3, 2, 1)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(1, 3, 2, 2)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(1, 3, 2, 3)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(1, 3, 3, 0)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(1, 3, 3, 1)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(1, 3, 3, 2)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(1, 3, 3, 3)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(2, 0, 0, 0)] = KEYPAIR(   No, A,              Sh, A             ),
+    [CHRD(2, 0, 0, 1)] = KEYPAIR(   Ag, W,           Ag|Sh, W             ),
+    [CHRD(2, 0, 0, 2)] = KEYPAIR(   No, N,              Sh, N             ),
+    [CHRD(2, 0, 0, 3)] = KEYPAIR(   Ag, 4,           Ag|Sh, 4             ),
+    [CHRD(2, 0, 1, 0)] = KEYPAIR(   No, SCOLON,         Sh, SCOLON        ),
+    [CHRD(2, 0, 1, 1)] = KEYPAIR(   Ag, C,           Ag|Sh, C             ),
+    [CHRD(2, 0, 1, 2)] = KEYPAIR(   Ag, GRAVE,       Ag|Sh, GRAVE         ),
+    [CHRD(2, 0, 1, 3)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(2, 0, 2, 0)] = KEYPAIR(   No, O,              Sh, O             ),
+    [CHRD(2, 0, 2, 1)] = KEYPAIR(   Ag, 6,           Ag|Sh, 6             ),
+    [CHRD(2, 0, 2, 2)] = KEYPAIR(   No, U,              Sh, U             ),
+    [CHRD(2, 0, 2, 3)] = KEYPAIR(   Ag, G,           Ag|Sh, G             ),
+    [CHRD(2, 0, 3, 0)] = KEYPAIR(   Ag, P,           Ag|Sh, P             ),
+    [CHRD(2, 0, 3, 1)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(2, 0, 3, 2)] = KEYPAIR(   No, LANG2,          No, INT2          ),
+    [CHRD(2, 0, 3, 3)] = KEYPAIR(   No, LANG3,          No, INT3          ),
+    [CHRD(2, 1, 0, 0)] = KEYPAIR(   No, J,              Sh, J             ),
+    [CHRD(2, 1, 0, 1)] = KEYPAIR(   No, LANG5,          No, INT5          ),
+    [CHRD(2, 1, 0, 2)] = KEYPAIR(   No, LANG6,          No, INT6          ),
+    [CHRD(2, 1, 0, 3)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(2, 1, 1, 0)] = KEYPAIR(   No, LANG8,          No, INT8          ),
+    [CHRD(2, 1, 1, 1)] = KEYPAIR(   No, LANG9,          No, INT9          ),
+    [CHRD(2, 1, 1, 2)] = KEYPAIR(   No, _MUTE,          No, PAUSE         ),
+    [CHRD(2, 1, 1, 3)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(2, 1, 2, 0)] = KEYPAIR(   No, PSCREEN,        No, SYSREQ        ),
+    [CHRD(2, 1, 2, 1)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(2, 1, 2, 2)] = KEYPAIR(   No, LANG7,          No, INT7          ),
+    [CHRD(2, 1, 2, 3)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(2, 1, 3, 0)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(2, 1, 3, 1)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(2, 1, 3, 2)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(2, 1, 3, 3)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(2, 2, 0, 0)] = KEYPAIR(   No, L,              Sh, L             ),
+    [CHRD(2, 2, 0, 1)] = KEYPAIR(   Ag, K,           Ag|Sh, K             ),
+    [CHRD(2, 2, 0, 2)] = KEYPAIR(   No, M,              Sh, M             ),
+    [CHRD(2, 2, 0, 3)] = KEYPAIR(   No, STOP,           Ag, E             ),
+    [CHRD(2, 2, 1, 0)] = KEYPAIR(   No, KP_0,           No, NO            ),
+    [CHRD(2, 2, 1, 1)] = KEYPAIR(   No, KP_8,           No, POWER         ),
+    [CHRD(2, 2, 1, 2)] = KEYPAIR(   No, KP_2,           No, NO            ),
+    [CHRD(2, 2, 1, 3)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(2, 2, 2, 0)] = KEYPAIR(   No, F,              Sh, F             ),
+    [CHRD(2, 2, 2, 1)] = KEYPAIR(   No, KP_SLASH,       No, NO            ),
+    [CHRD(2, 2, 2, 2)] = KEYPAIR(   No, H,              Sh, H             ),
+    [CHRD(2, 2, 2, 3)] = KEYPAIR(   Ag, S,           Ag|Sh, S             ),
+    [CHRD(2, 2, 3, 0)] = KEYPAIR(   Ag, H,           Ag|Sh, H             ),
+    [CHRD(2, 2, 3, 1)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(2, 2, 3, 2)] = KEYPAIR(   Ag, R,           Ag|Sh, R             ),
+    [CHRD(2, 2, 3, 3)] = KEYPAIR(   Ag, Q,           Ag|Sh, Q             ),
+    [CHRD(2, 3, 0, 0)] = KEYPAIR(   No, NONUS_BSLASH,   Sh, NONUS_BSLASH  ),
+    [CHRD(2, 3, 0, 1)] = KEYPAIR(   Ag, Y,           Ag|Sh, Y             ),
+    [CHRD(2, 3, 0, 2)] = KEYPAIR(   Ag, 3,           Ag|Sh, 3             ),
+    [CHRD(2, 3, 0, 3)] = KEYPAIR(   Ag, DOT,            Ag, COMMA         ),
+    [CHRD(2, 3, 1, 0)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(2, 3, 1, 1)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(2, 3, 1, 2)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(2, 3, 1, 3)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(2, 3, 2, 0)] = KEYPAIR(   No, _VOLDOWN,       No, _VOLUP        ),
+    [CHRD(2, 3, 2, 1)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(2, 3, 2, 2)] = KEYPAIR(   No, INSERT,      Ag|Sh, BSLASH        ),
+    [CHRD(2, 3, 2, 3)] = KEYPAIR(   Ag, O,           Ag|Sh, O             ),
+    [CHRD(2, 3, 3, 0)] = KEYPAIR(   Ag, 1,           Ag|Sh, 1             ),
+    [CHRD(2, 3, 3, 1)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(2, 3, 3, 2)] = KEYPAIR(   Ag, N,           Ag|Sh, N             ),
+    [CHRD(2, 3, 3, 3)] = KEYPAIR(   Ag, M,           Ag|Sh, M             ),
+    [CHRD(3, 0, 0, 0)] = KEYPAIR(   No, NONUS_HASH,     Sh, NONUS_HASH    ),
+    [CHRD(3, 0, 0, 1)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(3, 0, 0, 2)] = KEYPAIR(   No, KP_COMMA,    Ag|Sh, 7             ),
+    [CHRD(3, 0, 0, 3)] = KEYPAIR(   No, ENTER,          No, NO            ),
+    [CHRD(3, 0, 1, 0)] = KEYPAIR(   No, FN7,            No, NO            ),
+    [CHRD(3, 0, 1, 1)] = KEYPAIR(   No, NO,          Ag|Sh, 0             ),
+    [CHRD(3, 0, 1, 2)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(3, 0, 1, 3)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(3, 0, 2, 0)] = KEYPAIR(   No, LBRACKET,       Sh, LBRACKET      ),
+    [CHRD(3, 0, 2, 1)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(3, 0, 2, 2)] = KEYPAIR(   Ag, A,           Ag|Sh, A             ),
+    [CHRD(3, 0, 2, 3)] = KEYPAIR(Ag|Sh, NONUS_BSLASH,Ag|Sh, MINUS         ),
+    [CHRD(3, 0, 3, 0)] = KEYPAIR(   No, TAB,            Sh, TAB           ),
+    [CHRD(3, 0, 3, 1)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(3, 0, 3, 2)] = KEYPAIR(   No, AGAIN,       Ag|Sh, RBRACKET      ),
+    [CHRD(3, 0, 3, 3)] = KEYPAIR(   No, EQUAL,          Sh, EQUAL         ),
+    [CHRD(3, 1, 0, 0)] = KEYPAIR(   No, FN1,            No, NO            ),
+    [CHRD(3, 1, 0, 1)] = KEYPAIR(   Ag, SCOLON,      Ag|Sh, LBRACKET      ),
+    [CHRD(3, 1, 0, 2)] = KEYPAIR(   Ag, QUOTE,       Ag|Sh, QUOTE         ),
+    [CHRD(3, 1, 0, 3)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(3, 1, 1, 0)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(3, 1, 1, 1)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(3, 1, 1, 2)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(3, 1, 1, 3)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(3, 1, 2, 0)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(3, 1, 2, 1)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(3, 1, 2, 2)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(3, 1, 2, 3)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(3, 1, 3, 0)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(3, 1, 3, 1)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(3, 1, 3, 2)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(3, 1, 3, 3)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(3, 2, 0, 0)] = KEYPAIR(   Sh, 8,              Sh, 9             ),
+    [CHRD(3, 2, 0, 1)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(3, 2, 0, 2)] = KEYPAIR(   Ag, V,           Ag|Sh, V             ),
+    [CHRD(3, 2, 0, 3)] = KEYPAIR(   Sh, 5,              Sh, 6             ),
+    [CHRD(3, 2, 1, 0)] = KEYPAIR(   No, KP_MINUS,       No, KP_PLUS       ),
+    [CHRD(3, 2, 1, 1)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(3, 2, 1, 2)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(3, 2, 1, 3)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(3, 2, 2, 0)] = KEYPAIR(   No, HOME,           No, END           ),
+    [CHRD(3, 2, 2, 1)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(3, 2, 2, 2)] = KEYPAIR(   Ag, L,           Ag|Sh, L             ),
+    [CHRD(3, 2, 2, 3)] = KEYPAIR(   No, PGUP,           No, PGDOWN        ),
+    [CHRD(3, 2, 3, 0)] = KEYPAIR(   Ag, B,           Ag|Sh, B             ),
+    [CHRD(3, 2, 3, 1)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(3, 2, 3, 2)] = KEYPAIR(   Ag, J,           Ag|Sh, J             ),
+    [CHRD(3, 2, 3, 3)] = KEYPAIR(Ag|Sh, Y,           Ag|Sh, I             ),
+    [CHRD(3, 3, 0, 0)] = KEYPAIR(   No, RBRACKET,       Sh, RBRACKET      ),
+    [CHRD(3, 3, 0, 1)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(3, 3, 0, 2)] = KEYPAIR(   Ag, F,           Ag|Sh, F             ),
+    [CHRD(3, 3, 0, 3)] = KEYPAIR(   Sh, 0,              Sh, 2             ),
+    [CHRD(3, 3, 1, 0)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(3, 3, 1, 1)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(3, 3, 1, 2)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(3, 3, 1, 3)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(3, 3, 2, 0)] = KEYPAIR(   No, F23,            No, F24           ),
+    [CHRD(3, 3, 2, 1)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(3, 3, 2, 2)] = KEYPAIR(   No, FIND,           No, NO            ),
+    [CHRD(3, 3, 2, 3)] = KEYPAIR(   No, COPY,           No, CUT           ),
+    [CHRD(3, 3, 3, 0)] = KEYPAIR(   Ag, NONUS_BSLASH,   Ag, RBRACKET      ),
+    [CHRD(3, 3, 3, 1)] = KEYPAIR(   No, NO,             No, NO            ),
+    [CHRD(3, 3, 3, 2)] = KEYPAIR(   No, LANG1,          No, INT1          ),
+    [CHRD(3, 3, 3, 3)] = KEYPAIR(   No, BSPACE,         No, DELETE        ),
@@ -35,6 +35,108 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 /* Set 0 if debouncing isn't needed */
 #define DEBOUNCE 5
 
+/* wait after selecting a matrix column before reading the rows;
+   KEYMAP=selftest measures what a unit needs */
+#ifndef MATRIX_SETTLE_US
+#define MATRIX_SETTLE_US 30
+#endif
+
+/*
+ * Chord mode options (nan-15_chord.c)
+ */
+
+/* type a lone finger key if no other key joins it within this many
+   microseconds (< 250000); 0 waits for key release as usual */
+#ifndef HYBRID_WINDOW_US
+#define HYBRID_WINDOW_US 0
+#endif
+
+/* type the nearest mapped chord instead of an unmapped one if there is
+   exactly one */
+#ifndef CORRECT_CHRDS
+#define CORRECT_CHRDS 0
+#endif
+
+/* let the key pressed first select the ord_chrdmap entries of a chord */
+#ifndef ORD_CHRDS
+#define ORD_CHRDS 0
+#endif
+
+/* type a chord held for REPEAT_DELAY ms and repeat its keycode every
+   REPEAT_INTERVAL ms while held (e.g. 500 and 40); 0 disables */
+#ifndef REPEAT_DELAY
+#define REPEAT_DELAY 0
+#endif
+#ifndef REPEAT_INTERVAL
+#define REPEAT_INTERVAL 40
+#endif
+
+/* record the last TRACE_LEN (a power of 2, e.g. 32) key, chord, report,
+   EEPROM, and LED events for dumping by chord; 0 disables */
+#ifndef TRACE_LEN
+#define TRACE_LEN 0
+#endif
+
+/* count chord usage approximately in RAM and print it with the
+   chordmaps */
+#ifndef USAGE_COUNTS
+#define USAGE_COUNTS 0
+#endif
+
+/* collect histograms of chord key press spread, hold time, and gap
+   between chords, and measure typing speed; printed with the
+   chordmaps */
+#ifndef TYPING_STATS
+#define TYPING_STATS 0
+#endif
+
+/* time the matrix scan, TMK actions, and our own tasks in every loop
+   pass and add the profile to the statistics printed with the
+   chordmaps */
+#ifndef PROFILE
+#define PROFILE 0
+#endif
+
+/* number of chordmap profiles to cycle through by chord: 0 is the
+   customizable one in EEPROM, 1 a copy of the initial chrdmap kept in
+   flash; up to 4 once further layouts are added to chrdmap_profile[] */
+#ifndef CHRDMAP_PROFILES
+#define CHRDMAP_PROFILES 1
+#endif
+
+/* scan the matrix from reset on and buffer up to FAST_BOOT (e.g. 32)
+   key events until USB is configured; 0 leaves scanning to TMK */
+#ifndef FAST_BOOT
+#define FAST_BOOT 0
+#endif
+
+/* let a chord tap Caps Lock RTT_ROUNDS (even, e.g. 16) times, timing
+   each host LED echo, and type the round-trip latencies with the
+   statistics; 0 disables */
+#ifndef RTT_ROUNDS
+#define RTT_ROUNDS 0
+#endif
+
+/* mark code sections in GPIOR0 for the simavr benchmark (bench.h) */
+#ifndef BENCH
+#define BENCH 0
+#endif
+
+/*
+ * Buffered debug console (dlog.h): per-subsystem levels from 0 (off)
+ * to 3 (DLOG_DEBUG); output needs CONSOLE_ENABLE in Makefile
+ */
+#ifndef DLOG_MATRIX
+#define DLOG_MATRIX 0
+#endif
+#ifndef DLOG_CHRD
+#define DLOG_CHRD 0
+#endif
+/* results of KEYMAP=scanbench, which the Makefile sets to DLOG_INFO */
+#ifndef DLOG_SCANBENCH
+#define DLOG_SCANBENCH 0
+#endif
+
 /*
  * Feature disable options
  *  These options are also useful to firmware size reduction.
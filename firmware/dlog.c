@@ -0,0 +1,132 @@
+/*
+Copyright 2017 Bert Burgemeister <trebbu@googlemail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * buffered debug console
+ */
+
+#include "dlog.h"
+#include "sendchar.h"
+#include "lufa.h"
+#include <stdbool.h>
+#include <util/atomic.h>
+
+#if DLOG_ENABLE
+
+#define DLOG_BUFLEN 64          /* power of 2 */
+#define DLOG_DRAIN_MAX 8        /* characters per loop pass */
+
+static char buf[DLOG_BUFLEN];
+static uint8_t head = 0, tail = 0;
+static bool lost = false;
+
+/*
+ * Characters that don't fit are dropped; a '~' marks the gap.
+ */
+static void
+put(char c)
+{
+    uint8_t next = (head + 1) & (DLOG_BUFLEN - 1);
+
+    if (next == tail) {
+        lost = true;
+        return;
+    }
+    if (lost) {
+        buf[head] = '~';
+        head = next;
+        lost = false;
+        put(c);
+        return;
+    }
+    buf[head] = c;
+    head = next;
+}
+
+void
+dlog_puts_P(const char *str)
+{
+    char c;
+
+    while ((c = pgm_read_byte(str++)))
+        put(c);
+}
+
+void
+dlog_hex8(uint8_t val)
+{
+    static const char digit[] PROGMEM = "0123456789ABCDEF";
+
+    put(pgm_read_byte(digit + (val>>4)));
+    put(pgm_read_byte(digit + (val & 0xf)));
+}
+
+void
+dlog_dec32(uint32_t val)
+{
+    uint32_t div = 1000000000;
+
+    while (div > 1 && val < div)
+        div /= 10;
+    for (; div; div /= 10)
+        put('0' + val / div % 10);
+}
+
+/*
+ * True when everything logged has been sent
+ */
+bool
+dlog_idle(void)
+{
+    return tail == head;
+}
+
+/*
+ * True if the console endpoint bank has room, so sendchar() won't wait
+ * for the host to poll
+ */
+static bool
+console_ready(void)
+{
+    uint8_t ep;
+    bool ready;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        ep = Endpoint_GetCurrentEndpoint();
+        Endpoint_SelectEndpoint(CONSOLE_IN_EPNUM);
+        ready = Endpoint_IsReadWriteAllowed();
+        Endpoint_SelectEndpoint(ep);
+    }
+    return ready;
+}
+
+/*
+ * Send a few buffered characters; leave the rest for later if the
+ * console is busy
+ */
+void
+dlog_drain(void)
+{
+    uint8_t n;
+
+    for (n = 0; n < DLOG_DRAIN_MAX && tail != head; n++) {
+        if (!console_ready() || sendchar(buf[tail]))
+            return;
+        tail = (tail + 1) & (DLOG_BUFLEN - 1);
+    }
+}
+#endif
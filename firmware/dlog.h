@@ -0,0 +1,72 @@
+/*
+Copyright 2017 Bert Burgemeister <trebbu@googlemail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Debug console output that doesn't block: messages go into a ring
+ * buffer which dlog_drain() sends from the main loop while the console
+ * takes them.  Each subsystem SUB logs up to level DLOG_SUB from
+ * config.h; calls above that level compile to nothing, and so does
+ * the whole console while all levels are 0.
+ */
+
+#ifndef DLOG_H
+#define DLOG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <avr/pgmspace.h>
+
+#define DLOG_ERR 1
+#define DLOG_INFO 2
+#define DLOG_DEBUG 3
+
+/* the ring buffer only exists if some subsystem logs */
+#define DLOG_ENABLE (DLOG_MATRIX || DLOG_CHRD || DLOG_SCANBENCH)
+
+#define dlog(sub, level, str)                           \
+    do {                                                \
+        if (DLOG_##sub >= (level))                      \
+            dlog_puts_P(PSTR(str));                     \
+    } while (0)
+
+#define dlog_hex(sub, level, val)                       \
+    do {                                                \
+        if (DLOG_##sub >= (level))                      \
+            dlog_hex8(val);                             \
+    } while (0)
+
+#define dlog_dec(sub, level, val)                       \
+    do {                                                \
+        if (DLOG_##sub >= (level))                      \
+            dlog_dec32(val);                            \
+    } while (0)
+
+#if DLOG_ENABLE
+void dlog_puts_P(const char *str);
+void dlog_hex8(uint8_t val);
+void dlog_dec32(uint32_t val);
+bool dlog_idle(void);
+void dlog_drain(void);
+#else
+#define dlog_puts_P(str) do {} while (0)
+#define dlog_hex8(val) do {} while (0)
+#define dlog_dec32(val) do {} while (0)
+#define dlog_idle() true
+#define dlog_drain() do {} while (0)
+#endif
+
+#endif
@@ -0,0 +1,97 @@
+/*
+Copyright 2017 Bert Burgemeister <trebbu@googlemail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * EEPROM image in Intel HEX files as made by avr-objcopy
+ */
+
+#include <stdio.h>
+#include "sim.h"
+
+
+#define EEP_LINE_LEN 16
+
+/* bounds of the eeprom section holding the EEMEM variables */
+extern uint8_t __start_eeprom[], __stop_eeprom[];
+
+uint16_t
+eep_addr(const void *p)
+{
+    return (const uint8_t *)p - __start_eeprom;
+}
+
+uint16_t
+eep_size(void)
+{
+    return __stop_eeprom - __start_eeprom;
+}
+
+/*
+ * Return 0 on success
+ */
+int
+eep_load(const char *filename)
+{
+    FILE *f = fopen(filename, "r");
+    unsigned int len, addr, type, byte, i;
+    char line[600];
+    int err = -1;
+
+    if (!f)
+        return -1;
+    while (fgets(line, sizeof(line), f)) {
+        if (sscanf(line, ":%2x%4x%2x", &len, &addr, &type) != 3)
+            break;
+        if (type == 1) {
+            err = 0;
+            break;
+        }
+        if (type != 0 || addr + len > eep_size())
+            break;
+        for (i = 0; i < len; i++) {
+            if (sscanf(line + 9 + 2 * i, "%2x", &byte) != 1)
+                goto out;
+            __start_eeprom[addr + i] = byte;
+        }
+    }
+out:
+    fclose(f);
+    return err;
+}
+
+int
+eep_save(const char *filename)
+{
+    FILE *f = fopen(filename, "w");
+    unsigned int size = eep_size(), addr, len, i;
+    uint8_t sum;
+
+    if (!f)
+        return -1;
+    for (addr = 0; addr < size; addr += len) {
+        len = size - addr < EEP_LINE_LEN ? size - addr : EEP_LINE_LEN;
+        sum = len + (addr>>8) + addr;
+        fprintf(f, ":%02X%04X00", len, addr);
+        for (i = 0; i < len; i++) {
+            fprintf(f, "%02X", __start_eeprom[addr + i]);
+            sum += __start_eeprom[addr + i];
+        }
+        fprintf(f, "%02X\n", (uint8_t)-sum);
+    }
+    fprintf(f, ":00000001FF\n");
+    return fclose(f);
+}
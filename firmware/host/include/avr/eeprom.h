@@ -0,0 +1,51 @@
+/*
+ * Host stand-in: EEMEM variables are kept together in the eeprom
+ * section, in the order of definition (-fno-toplevel-reorder), which
+ * host/eep.c loads from and saves to .eep files.  Byte writes are
+ * reported to host/sim.c.
+ */
+#ifndef HOST_AVR_EEPROM_H
+#define HOST_AVR_EEPROM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define EEMEM __attribute__((section("eeprom")))
+
+void sim_eeprom_write(uint8_t *addr, uint8_t val);
+
+static inline uint8_t
+eeprom_read_byte(const uint8_t *p)
+{
+    return *p;
+}
+
+static inline uint16_t
+eeprom_read_word(const uint16_t *p)
+{
+    return *p;
+}
+
+static inline void
+eeprom_read_block(void *dst, const void *src, size_t n)
+{
+    memcpy(dst, src, n);
+}
+
+static inline void
+eeprom_write_byte(uint8_t *p, uint8_t val)
+{
+    sim_eeprom_write(p, val);
+}
+
+static inline void
+eeprom_update_byte(uint8_t *p, uint8_t val)
+{
+    if (*p != val)
+        sim_eeprom_write(p, val);
+}
+
+#define eeprom_is_ready() 1
+
+#endif
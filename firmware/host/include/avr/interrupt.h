@@ -0,0 +1,13 @@
+/*
+ * Host stand-in: ISRs are ordinary functions, called by host/sim.c
+ */
+#ifndef HOST_AVR_INTERRUPT_H
+#define HOST_AVR_INTERRUPT_H
+
+#include <avr/io.h>
+
+#define ISR(vector) void vector(void)
+#define sei()
+#define cli()
+
+#endif
@@ -0,0 +1,25 @@
+/*
+ * Host stand-in: the I/O registers used by the firmware are plain
+ * variables defined in host/sim.c.
+ */
+#ifndef HOST_AVR_IO_H
+#define HOST_AVR_IO_H
+
+#include <stdint.h>
+
+extern volatile uint8_t PORTB, PORTC, PORTD, PINB, PINC, PIND, DDRB, DDRC, DDRD;
+extern volatile uint8_t TCCR1A, TCCR1B, TIMSK1, TIFR1, GPIOR0;
+extern volatile uint16_t TCNT1, OCR1A, OCR1B;
+
+#define CS10 0
+#define CS11 1
+#define CS12 2
+#define OCIE1A 1
+#define OCIE1B 2
+#define OCF1A 1
+#define OCF1B 2
+
+#define TIMER1_COMPA_vect timer1_compa_vect
+#define TIMER1_COMPB_vect timer1_compb_vect
+
+#endif
@@ -0,0 +1,18 @@
+/*
+ * Host stand-in: program memory is ordinary memory
+ */
+#ifndef HOST_AVR_PGMSPACE_H
+#define HOST_AVR_PGMSPACE_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PSTR(s) (s)
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+#define strcpy_P strcpy
+#define strlen_P strlen
+#define memcpy_P memcpy
+
+#endif
@@ -0,0 +1,11 @@
+/*
+ * Host stand-in: there are no interrupts to hold off
+ */
+#ifndef HOST_UTIL_ATOMIC_H
+#define HOST_UTIL_ATOMIC_H
+
+#define ATOMIC_RESTORESTATE
+#define ATOMIC_FORCEON
+#define ATOMIC_BLOCK(type) for (int atomic_once_ = 1; atomic_once_; atomic_once_ = 0)
+
+#endif
@@ -0,0 +1,14 @@
+/*
+ * Host stand-in: busy waits advance simulated time
+ */
+#ifndef HOST_UTIL_DELAY_H
+#define HOST_UTIL_DELAY_H
+
+#include <stdint.h>
+
+void sim_delay_us(uint32_t us);
+
+#define _delay_us(us) sim_delay_us(us)
+#define _delay_ms(ms) sim_delay_us((ms) * 1000UL)
+
+#endif
@@ -0,0 +1,255 @@
+/*
+Copyright 2017 Bert Burgemeister <trebbu@googlemail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Run the keymap against a key script read from stdin and print what
+ * a US-layout host would type, or, with -l, a timestamped log of
+ * reports, LED port states, EEPROM writes, and the latency from the
+ * first key press of each chord to the first report of a new key.
+ * Script lines:
+ *
+ *     d ROW COL   press the switch at matrix ROW, COL
+ *     u ROW COL   release it
+ *     w MS        let MS milliseconds pass
+ *     l LEDS      set the host keyboard LEDs
+ *     # ...       comment
+ *
+ * A d, u, or l line may start with the time in ms (fractions allowed)
+ * since the start at which it happens.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "keycode.h"
+#include "sim.h"
+
+
+static const char *const unshifted[] = {
+    [KC_1] = "1", "2", "3", "4", "5", "6", "7", "8", "9", "0",
+    [KC_ENTER] = "\n", [KC_TAB] = "\t", [KC_SPACE] = " ",
+    [KC_MINUS] = "-", "=", "[", "]", "\\", [KC_SCOLON] = ";", "'", "`", ",", ".", "/",
+    [KC_KP_SLASH] = "/", "*", "-", "+", "\n", "1", "2", "3", "4", "5", "6", "7", "8", "9", "0", ".",
+    [KC_NONUS_BSLASH] = "<",
+};
+
+static const char *const shifted[] = {
+    [KC_1] = "!", "@", "#", "$", "%", "^", "&", "*", "(", ")",
+    [KC_ENTER] = "\n", [KC_TAB] = "\t", [KC_SPACE] = " ",
+    [KC_MINUS] = "_", "+", "{", "}", "|", [KC_SCOLON] = ":", "\"", "~", "<", ">", "?",
+    [KC_KP_SLASH] = "/", "*", "-", "+", "\n", "1", "2", "3", "4", "5", "6", "7", "8", "9", "0", ".",
+    [KC_NONUS_BSLASH] = ">",
+};
+
+#define SHIFT (MOD_BIT(KC_LSHIFT) | MOD_BIT(KC_RSHIFT))
+
+static bool logging;
+
+static struct {
+    uint32_t down;              /* switches, bit ROW * MATRIX_COLS + COL */
+    uint32_t keys;              /* switches pressed during this chord */
+    uint64_t start;             /* us */
+    bool pending;               /* no new key reported yet */
+    uint32_t n, min, max;
+    uint64_t sum;
+} chrd;
+
+static void
+log_time(void)
+{
+    uint64_t now = sim_now_us();
+
+    printf("%6llu.%03u ", (unsigned long long)(now / 1000), (unsigned int)(now % 1000));
+}
+
+static void
+key(uint8_t row, uint8_t col, bool pressed)
+{
+    uint32_t bit = 1UL << (row * MATRIX_COLS + col);
+
+    if (pressed) {
+        if (!chrd.down) {
+            chrd.keys = 0;
+            chrd.start = sim_now_us();
+            chrd.pending = true;
+        }
+        chrd.down |= bit;
+        chrd.keys |= bit;
+    } else {
+        chrd.down &= ~bit;
+    }
+    if (logging) {
+        log_time();
+        printf("key %u %u %s\n", row, col, pressed ? "down" : "up");
+    }
+    sim_key(row, col, pressed);
+}
+
+static void
+latency(void)
+{
+    uint32_t us = sim_now_us() - chrd.start;
+
+    chrd.pending = false;
+    if (!chrd.n || us < chrd.min)
+        chrd.min = us;
+    if (us > chrd.max)
+        chrd.max = us;
+    chrd.sum += us;
+    chrd.n++;
+    if (logging) {
+        log_time();
+        printf("latency %04x %u.%03u\n", chrd.keys, us / 1000, us % 1000);
+    }
+}
+
+static void
+on_leds(uint8_t portb, uint8_t portc, uint8_t portd)
+{
+    log_time();
+    printf("leds %02x %02x %02x\n", portb, portc, portd);
+}
+
+static void
+on_eeprom(uint16_t addr, uint8_t val)
+{
+    log_time();
+    printf("eeprom %03x %02x\n", addr, val);
+}
+
+static void
+type(uint8_t mods, uint8_t code)
+{
+    const char *s;
+
+    if (mods & ~SHIFT)
+        printf("<%02x+%02x>", mods, code);
+    else if (code >= KC_A && code <= KC_Z)
+        putchar((mods ? 'A' : 'a') + code - KC_A);
+    else if (code < sizeof(shifted) / sizeof(shifted[0])
+             && (s = (mods ? shifted : unshifted)[code]))
+        fputs(s, stdout);
+    else
+        printf("<%02x>", code);
+}
+
+/*
+ * Type or log each key that is new in this report
+ */
+static void
+on_report(const report_keyboard_t *r)
+{
+    static uint8_t prev[KEYBOARD_REPORT_KEYS];
+    uint8_t i, j;
+
+    if (logging) {
+        log_time();
+        printf("report %02x", r->mods);
+        for (i = 0; i < KEYBOARD_REPORT_KEYS; i++)
+            printf(" %02x", r->keys[i]);
+        putchar('\n');
+    }
+    for (i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        if (!r->keys[i])
+            continue;
+        for (j = 0; j < KEYBOARD_REPORT_KEYS; j++)
+            if (prev[j] == r->keys[i])
+                break;
+        if (j == KEYBOARD_REPORT_KEYS) {
+            if (chrd.pending)
+                latency();
+            if (!logging)
+                type(r->mods, r->keys[i]);
+        }
+    }
+    memcpy(prev, r->keys, sizeof(prev));
+}
+
+static void
+usage(const char *name)
+{
+    fprintf(stderr, "usage: %s [-l] [-e in.eep] [-o out.eep] < script\n", name);
+    exit(2);
+}
+
+int
+main(int argc, char **argv)
+{
+    const char *in = NULL, *out = NULL;
+    char line[100], cmd, *p;
+    unsigned int a, b;
+    int opt, n = 0;
+    double t;
+
+    while ((opt = getopt(argc, argv, "le:o:")) != -1)
+        switch (opt) {
+        case 'l':
+            logging = true;
+            break;
+        case 'e':
+            in = optarg;
+            break;
+        case 'o':
+            out = optarg;
+            break;
+        default:
+            usage(argv[0]);
+        }
+    if (optind < argc)
+        usage(argv[0]);
+    if (in && eep_load(in)) {
+        fprintf(stderr, "%s: can't load\n", in);
+        return 1;
+    }
+    sim_on_report = on_report;
+    if (logging) {
+        sim_on_leds = on_leds;
+        sim_on_eeprom = on_eeprom;
+    }
+    sim_init();
+    while (fgets(line, sizeof(line), stdin)) {
+        n++;
+        t = strtod(line, &p);
+        if (p != line && t * 1000 > sim_now_us())
+            sim_run(t * 1000 - sim_now_us());
+        if (sscanf(p, " %c", &cmd) != 1 || cmd == '#')
+            continue;
+        if ((cmd == 'd' || cmd == 'u') && sscanf(p, " %c %u %u", &cmd, &a, &b) == 3
+            && a < MATRIX_ROWS && b < MATRIX_COLS)
+            key(a, b, cmd == 'd');
+        else if (cmd == 'w' && p == line && sscanf(p, " %c %u", &cmd, &a) == 2)
+            sim_run(a * 1000);
+        else if (cmd == 'l' && sscanf(p, " %c %u", &cmd, &a) == 2)
+            sim_set_host_leds(a);
+        else {
+            fprintf(stderr, "line %d: bad command\n", n);
+            return 1;
+        }
+        fflush(stdout);
+    }
+    if (logging && chrd.n)
+        printf("%u chords, latency ms min %u.%03u avg %u.%03u max %u.%03u\n",
+               chrd.n, chrd.min / 1000, chrd.min % 1000,
+               (uint32_t)(chrd.sum / chrd.n) / 1000, (uint32_t)(chrd.sum / chrd.n) % 1000,
+               chrd.max / 1000, chrd.max % 1000);
+    if (out && eep_save(out)) {
+        fprintf(stderr, "%s: can't save\n", out);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,496 @@
+/*
+Copyright 2017 Bert Burgemeister <trebbu@googlemail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Simulated keyboard
+ */
+
+#include <string.h>
+#include "action.h"
+#include "action_layer.h"
+#include "action_util.h"
+#include "hook.h"
+#include "host.h"
+#include "keyboard.h"
+#include "led.h"
+#include "matrix.h"
+#include "sendchar.h"
+#include "timer.h"
+#include <avr/interrupt.h>
+#include "sim.h"
+
+
+volatile uint8_t PORTB, PORTC, PORTD, PINB, PINC, PIND, DDRB, DDRC, DDRD;
+volatile uint8_t TCCR1A, TCCR1B, TIMSK1, TIFR1, GPIOR0;
+volatile uint16_t TCNT1, OCR1A, OCR1B;
+
+void TIMER1_COMPA_vect(void);
+
+void (*sim_on_report)(const report_keyboard_t *report);
+void (*sim_on_eeprom)(uint16_t addr, uint8_t val);
+void (*sim_on_leds)(uint8_t portb, uint8_t portc, uint8_t portd);
+
+static uint64_t now_us;
+static uint64_t now_ticks;     /* Timer1 */
+static uint8_t host_leds, host_leds_seen;
+static uint64_t leds_window_start;
+static uint8_t leds_seen[3], leds_now[3];
+
+
+/*************************************************************
+ * Time
+ *************************************************************/
+
+/*
+ * Timer1 runs at F_CPU/64 once started.  Compare A calls its ISR;
+ * compare B only raises its flag.  Flags are never cleared by writing
+ * 1 to them as on the AVR, so the scheduler sees spurious wakeups,
+ * which it tolerates.
+ */
+static bool
+passes(uint16_t compare, uint64_t from, uint64_t to)
+{
+    return (uint16_t)(compare - (uint16_t)from - 1) < to - from;
+}
+
+static void
+sample_leds(void)
+{
+    leds_now[0] |= PORTB & DDRB;
+    leds_now[1] |= PORTC & DDRC;
+    leds_now[2] |= PORTD & DDRD;
+}
+
+/*
+ * An output pin counts as lit if it was high at any time within a
+ * window as long as a brightness modulation cycle
+ */
+static void
+check_leds(void)
+{
+    if (now_us - leds_window_start < SIM_LED_WINDOW_US)
+        return;
+    leds_window_start = now_us;
+    sample_leds();
+    if (memcmp(leds_now, leds_seen, sizeof(leds_seen))) {
+        memcpy(leds_seen, leds_now, sizeof(leds_seen));
+        if (sim_on_leds)
+            sim_on_leds(leds_seen[0], leds_seen[1], leds_seen[2]);
+    }
+    memset(leds_now, 0, sizeof(leds_now));
+}
+
+static void
+advance(uint32_t us)
+{
+    while (us) {
+        uint32_t step = us < 1000 ? us : 1000;
+        uint64_t to;
+
+        now_us += step;
+        us -= step;
+        if ((TCCR1B & 7) != (1<<CS11 | 1<<CS10)) {
+            check_leds();
+            continue;
+        }
+        to = now_us / (64 / (F_CPU / 1000000));
+        while (TIMSK1 & 1<<OCIE1A && passes(OCR1A, now_ticks, to)) {
+            now_ticks += (uint16_t)(OCR1A - (uint16_t)now_ticks);
+            TCNT1 = now_ticks;
+            TIMER1_COMPA_vect();
+            sample_leds();
+        }
+        if (passes(OCR1B, now_ticks, to))
+            TIFR1 |= 1<<OCF1B;
+        now_ticks = to;
+        TCNT1 = now_ticks;
+        check_leds();
+    }
+}
+
+uint64_t
+sim_now_us(void)
+{
+    return now_us;
+}
+
+void
+sim_delay_us(uint32_t us)
+{
+    advance(us);
+}
+
+uint16_t
+timer_read(void)
+{
+    return now_us / 1000;
+}
+
+uint32_t
+timer_read32(void)
+{
+    return now_us / 1000;
+}
+
+uint16_t
+timer_elapsed(uint16_t last)
+{
+    return timer_read() - last;
+}
+
+uint32_t
+timer_elapsed32(uint32_t last)
+{
+    return timer_read32() - last;
+}
+
+
+/*************************************************************
+ * TMK host, action_util, action, and layer parts
+ *************************************************************/
+
+static report_keyboard_t report;
+report_keyboard_t *keyboard_report = &report;
+static uint8_t real_mods, weak_mods;
+
+uint8_t
+host_keyboard_leds(void)
+{
+    return host_leds;
+}
+
+void
+host_keyboard_send(report_keyboard_t *r)
+{
+    if (sim_on_report)
+        sim_on_report(r);
+}
+
+void
+send_keyboard_report(void)
+{
+    report.mods = real_mods | weak_mods;
+    host_keyboard_send(&report);
+}
+
+uint8_t get_mods(void) { return real_mods; }
+void add_mods(uint8_t mods) { real_mods |= mods; }
+void del_mods(uint8_t mods) { real_mods &= ~mods; }
+void set_mods(uint8_t mods) { real_mods = mods; }
+void clear_mods(void) { real_mods = 0; }
+uint8_t get_weak_mods(void) { return weak_mods; }
+void add_weak_mods(uint8_t mods) { weak_mods |= mods; }
+void del_weak_mods(uint8_t mods) { weak_mods &= ~mods; }
+void set_weak_mods(uint8_t mods) { weak_mods = mods; }
+void clear_weak_mods(void) { weak_mods = 0; }
+
+void
+add_key(uint8_t key)
+{
+    int8_t i, empty = -1;
+
+    for (i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        if (report.keys[i] == key)
+            return;
+        if (empty < 0 && !report.keys[i])
+            empty = i;
+    }
+    if (empty >= 0)
+        report.keys[empty] = key;
+}
+
+void
+del_key(uint8_t key)
+{
+    uint8_t i;
+
+    for (i = 0; i < KEYBOARD_REPORT_KEYS; i++)
+        if (report.keys[i] == key)
+            report.keys[i] = 0;
+}
+
+void
+clear_keys(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < KEYBOARD_REPORT_KEYS; i++)
+        report.keys[i] = 0;
+}
+
+bool
+has_anykey(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < KEYBOARD_REPORT_KEYS; i++)
+        if (report.keys[i])
+            return true;
+    return false;
+}
+
+void
+clear_keyboard_but_mods(void)
+{
+    clear_weak_mods();
+    clear_keys();
+    send_keyboard_report();
+}
+
+void
+clear_keyboard(void)
+{
+    clear_mods();
+    clear_keyboard_but_mods();
+}
+
+void
+register_code(uint8_t code)
+{
+    if (IS_MOD(code)) {
+        add_mods(MOD_BIT(code));
+        send_keyboard_report();
+    } else if (code >= KC_A && code <= KC_EXSEL) {
+        add_key(code);
+        send_keyboard_report();
+    }
+}
+
+void
+unregister_code(uint8_t code)
+{
+    if (IS_MOD(code)) {
+        del_mods(MOD_BIT(code));
+        send_keyboard_report();
+    } else if (code >= KC_A && code <= KC_EXSEL) {
+        del_key(code);
+        send_keyboard_report();
+    }
+}
+
+uint32_t layer_state, default_layer_state;
+
+/* like TMK, which clears the keyboard to avoid stuck keys */
+static void
+layer_state_set(uint32_t state)
+{
+    layer_state = state;
+    clear_keyboard_but_mods();
+}
+
+void layer_clear(void) { layer_state_set(0); }
+void layer_move(uint8_t layer) { layer_state_set(1UL<<layer); }
+void layer_on(uint8_t layer) { layer_state_set(layer_state | 1UL<<layer); }
+void layer_off(uint8_t layer) { layer_state_set(layer_state & ~(1UL<<layer)); }
+
+action_t
+layer_switch_get_action(keypos_t key)
+{
+    uint32_t layers = layer_state | default_layer_state;
+    action_t a;
+    int8_t i;
+
+    for (i = 31; i >= 0; i--)
+        if (layers & 1UL<<i) {
+            a = action_for_key(i, key);
+            if (a.code != ACTION_TRANSPARENT)
+                return a;
+        }
+    return action_for_key(0, key);
+}
+
+/*
+ * TMK's action_exec() and process_action() for the action kinds found
+ * in keymaps here; mouse keys go nowhere
+ */
+void
+action_exec(keyevent_t e)
+{
+    action_t a = layer_switch_get_action(e.key);
+    keyrecord_t record = {.event = e};
+    uint8_t mods;
+
+    switch (a.kind.id) {
+    case ACT_LMODS:
+    case ACT_RMODS:
+        mods = a.kind.id == ACT_LMODS ? a.key.mods : a.key.mods<<4;
+        if (e.pressed) {
+            if (mods) {
+                add_weak_mods(mods);
+                send_keyboard_report();
+            }
+            register_code(a.key.code);
+        } else {
+            unregister_code(a.key.code);
+            if (mods) {
+                del_weak_mods(mods);
+                send_keyboard_report();
+            }
+        }
+        break;
+    case ACT_FUNCTION:
+        action_function(&record, a.func.id, a.func.opt);
+        break;
+    }
+}
+
+int8_t
+sendchar(uint8_t c)
+{
+    return 0;
+}
+
+void
+sim_eeprom_write(uint8_t *addr, uint8_t val)
+{
+    *addr = val;
+    if (sim_on_eeprom)
+        sim_on_eeprom(eep_addr(addr), val);
+}
+
+
+/*************************************************************
+ * Key matrix and main loop
+ *************************************************************/
+
+static matrix_row_t raw[MATRIX_ROWS], matrix[MATRIX_ROWS], matrix_prev[MATRIX_ROWS];
+static bool debouncing;
+static uint16_t last_change;
+static uint8_t selected_col;
+
+/* Timer1 around the scan, for PROFILE; scanning takes no time here */
+uint16_t matrix_scan_start, matrix_scan_end;
+
+void
+sim_key(uint8_t row, uint8_t col, bool pressed)
+{
+    if (pressed)
+        raw[row] |= 1<<col;
+    else
+        raw[row] &= ~(1<<col);
+    debouncing = true;
+    last_change = timer_read();
+}
+
+matrix_row_t
+matrix_get_row(uint8_t row)
+{
+    return matrix[row];
+}
+
+/*
+ * Raw matrix access for FAST_BOOT.  Its scan interrupt never fires
+ * here, as sim_init() goes straight from early to late init.
+ */
+void
+matrix_init(void)
+{
+}
+
+void
+matrix_select_col(uint8_t col)
+{
+    selected_col = col;
+}
+
+void
+matrix_unselect_cols(void)
+{
+}
+
+uint8_t
+matrix_read_rows(void)
+{
+    uint8_t r, rows = 0;
+
+    for (r = 0; r < MATRIX_ROWS; r++)
+        if (raw[r] & 1<<selected_col)
+            rows |= 1<<r;
+    return rows;
+}
+
+void
+keyboard_set_leds(uint8_t leds)
+{
+    led_set(leds);
+    hook_keyboard_leds_change(leds);
+}
+
+void
+sim_set_host_leds(uint8_t leds)
+{
+    host_leds = leds;
+}
+
+/*
+ * Like matrix.c and TMK's keyboard_task(): debounce, then act on at
+ * most one change per pass
+ */
+static void
+loop_pass(void)
+{
+    uint8_t r, c;
+
+    matrix_scan_start = TCNT1;
+    if (debouncing && timer_elapsed(last_change) >= DEBOUNCE) {
+        for (r = 0; r < MATRIX_ROWS; r++)
+            matrix[r] = raw[r];
+        debouncing = false;
+    }
+    matrix_scan_end = TCNT1;
+    for (r = 0; r < MATRIX_ROWS; r++) {
+        matrix_row_t change = matrix[r] ^ matrix_prev[r];
+
+        for (c = 0; c < MATRIX_COLS; c++)
+            if (change & 1<<c) {
+                keyevent_t e = {
+                    .key = {.row = r, .col = c},
+                    .pressed = matrix[r] & 1<<c,
+                    .time = timer_read() | 1,
+                };
+
+                action_exec(e);
+                hook_matrix_change(e);
+                matrix_prev[r] ^= 1<<c;
+                goto matrix_loop_end;
+            }
+    }
+matrix_loop_end:
+    hook_keyboard_loop();
+    if (host_leds != host_leds_seen) {
+        host_leds_seen = host_leds;
+        keyboard_set_leds(host_leds);
+    }
+}
+
+void
+sim_run(uint32_t us)
+{
+    uint64_t end = now_us + us;
+
+    while (now_us < end) {
+        advance(SIM_LOOP_US);
+        loop_pass();
+    }
+}
+
+void
+sim_init(void)
+{
+    hook_early_init();
+    hook_late_init();
+}
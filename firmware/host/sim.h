@@ -0,0 +1,50 @@
+/*
+Copyright 2017 Bert Burgemeister <trebbu@googlemail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Simulated keyboard for running a keymap on the workstation: time,
+ * key switches, the parts of TMK the keymap relies on, and EEPROM
+ * image files
+ */
+
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "report.h"
+
+#define SIM_LOOP_US 200         /* main loop period */
+#define SIM_LED_WINDOW_US 2048  /* LED sampling; >= one PWM cycle */
+
+void sim_init(void);
+uint64_t sim_now_us(void);
+void sim_key(uint8_t row, uint8_t col, bool pressed);
+void sim_run(uint32_t us);
+void sim_set_host_leds(uint8_t leds);
+
+/* observers; may be left NULL */
+extern void (*sim_on_report)(const report_keyboard_t *report);
+extern void (*sim_on_eeprom)(uint16_t addr, uint8_t val);
+extern void (*sim_on_leds)(uint8_t portb, uint8_t portc, uint8_t portd);
+
+uint16_t eep_addr(const void *p);
+uint16_t eep_size(void);
+int eep_load(const char *filename);
+int eep_save(const char *filename);
+
+#endif
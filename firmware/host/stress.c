@@ -0,0 +1,202 @@
+/*
+Copyright 2017 Bert Burgemeister <trebbu@googlemail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * Push random key sequences through the chord keymap and check, after
+ * each event and whenever all keys have been up for a while, that its
+ * state is sane: no stuck keys, keys_down within bounds
+ * and back at 0, no held layer left on, EEPROM writes within the
+ * EEPROM.  Prints the throughput in events per second.
+ *
+ * A failure names seed and event; -k then writes the same run as a key
+ * script for nan-15_chord_host -l.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "nan-15_chord.c"
+#include "sim.h"
+
+
+#define KEYS (MATRIX_ROWS * MATRIX_COLS)
+#define MAX_GAP_US 12000        /* between key events */
+#define RELEASE_ODDS 8          /* 1 in RELEASE_ODDS: release all keys */
+#define QUIET_US 60000          /* after releasing all */
+
+static uint32_t seed = 1, rnd_state;
+static uint32_t events, reports, ee_writes, quiet_checks;
+static uint32_t down;           /* bit ROW * MATRIX_COLS + COL */
+static report_keyboard_t last_report;
+static bool script;
+
+static uint32_t
+rnd(void)
+{
+    rnd_state ^= rnd_state << 13;
+    rnd_state ^= rnd_state >> 17;
+    rnd_state ^= rnd_state << 5;
+    return rnd_state;
+}
+
+static void
+fail(const char *what)
+{
+    uint64_t now = sim_now_us();
+
+    fprintf(stderr, "seed %u, event %u, %llu.%03u ms: %s\n", seed, events,
+            (unsigned long long)(now / 1000), (unsigned int)(now % 1000), what);
+    exit(1);
+}
+
+static void
+on_report(const report_keyboard_t *r)
+{
+    uint8_t i, j;
+
+    for (i = 0; i < KEYBOARD_REPORT_KEYS; i++)
+        for (j = i + 1; j < KEYBOARD_REPORT_KEYS; j++)
+            if (r->keys[i] && r->keys[i] == r->keys[j])
+                fail("key twice in a report");
+    last_report = *r;
+    reports++;
+}
+
+static void
+on_eeprom(uint16_t addr, uint8_t val)
+{
+    if (addr >= eep_size())
+        fail("EEPROM write out of bounds");
+    ee_writes++;
+}
+
+static void
+check_running(void)
+{
+    if (chrd.keys_down < 0 || chrd.keys_down > KEYS)
+        fail("keys_down out of bounds");
+    if (ee_queued > EE_QUEUE_LEN)
+        fail("EEPROM queue overrun");
+}
+
+static void
+check_quiet(void)
+{
+    uint8_t i;
+
+    if (chrd.keys_down || !chrd.ready || chrd.fng || chrd.thb || chrd.layer_pending)
+        fail("chord state not reset with all keys up");
+    if (chrd.hold_layer != L_DFLT || layer_state & 1UL<<L_THB_HOLD)
+        fail("held layer still on");
+    for (i = 0; i < KEYBOARD_REPORT_KEYS; i++)
+        if (last_report.keys[i])
+            fail("stuck key");
+    quiet_checks++;
+}
+
+static void
+key(uint8_t k, bool pressed)
+{
+    uint64_t now = sim_now_us();
+
+    if (script)
+        printf("%llu.%03u %c %u %u\n", (unsigned long long)(now / 1000),
+               (unsigned int)(now % 1000), pressed ? 'd' : 'u', k / MATRIX_COLS, k % MATRIX_COLS);
+    if (pressed)
+        down |= 1UL<<k;
+    else
+        down &= ~(1UL<<k);
+    sim_key(k / MATRIX_COLS, k % MATRIX_COLS, pressed);
+    events++;
+}
+
+/*
+ * The matrix has one position without a switch, AC_NO in every layer
+ */
+static bool
+is_switch(uint8_t k)
+{
+    keypos_t pos = {.row = k / MATRIX_COLS, .col = k % MATRIX_COLS};
+
+    return action_for_key(L_DFLT, pos).code != ACTION_NO;
+}
+
+static void
+print_usage(const char *name)
+{
+    fprintf(stderr, "usage: %s [-s seed] [-n events] [-k]\n", name);
+    exit(2);
+}
+
+int
+main(int argc, char **argv)
+{
+    uint32_t n = 1000000, k;
+    struct timespec t0, t1;
+    double secs;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "s:n:k")) != -1)
+        switch (opt) {
+        case 's':
+            seed = strtoul(optarg, NULL, 0);
+            break;
+        case 'n':
+            n = strtoul(optarg, NULL, 0);
+            break;
+        case 'k':
+            script = true;
+            break;
+        default:
+            print_usage(argv[0]);
+        }
+    if (optind < argc || !seed)
+        print_usage(argv[0]);
+    rnd_state = seed;
+    sim_on_report = on_report;
+    sim_on_eeprom = on_eeprom;
+    sim_init();
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    while (events < n) {
+        if (down && rnd() % RELEASE_ODDS == 0) {
+            for (k = 0; k < KEYS; k++)
+                if (down & 1UL<<k) {
+                    key(k, false);
+                    sim_run(rnd() % MAX_GAP_US);
+                    check_running();
+                }
+            sim_run(QUIET_US);
+            check_quiet();
+        } else {
+            if (!is_switch(k = rnd() % KEYS))
+                continue;
+            key(k, !(down & 1UL<<k));
+            sim_run(rnd() % MAX_GAP_US);
+            check_running();
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    secs = t1.tv_sec - t0.tv_sec + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+    if (script)
+        printf("w 500\n");
+    fprintf(stderr, "seed %u: %u events, %u quiet checks, %u reports, %u EEPROM writes"
+            " in %.2fs (%.0f events/s, %.1fs simulated)\n",
+            seed, events, quiet_checks, reports, ee_writes, secs, events / secs,
+            sim_now_us() / 1e6);
+    return 0;
+}
@@ -0,0 +1,86 @@
+/*
+Copyright 2017 Bert Burgemeister <trebbu@googlemail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * The 12 LEDs, numbered as in the picture in nan-15_chord.c, and a
+ * driver setting all of them at once from a bitmask per port
+ */
+
+#ifndef LEDS_H
+#define LEDS_H
+
+#include <stdint.h>
+#include <avr/io.h>
+#include <avr/pgmspace.h>
+
+enum led_port {LED_PORT_B, LED_PORT_C, LED_PORT_D, LED_PORTS};
+
+static const struct {
+    uint8_t port;
+    uint8_t mask;
+} led_pins[12] PROGMEM = {
+    {LED_PORT_D, 1<<0},
+    {LED_PORT_D, 1<<4},
+    {LED_PORT_D, 1<<5},
+    {LED_PORT_D, 1<<6},
+    {LED_PORT_B, 1<<0},
+    {LED_PORT_B, 1<<1},
+    {LED_PORT_B, 1<<4},
+    {LED_PORT_B, 1<<5},
+    {LED_PORT_B, 1<<6},
+    {LED_PORT_B, 1<<7},
+    {LED_PORT_C, 1<<5},
+    {LED_PORT_C, 1<<6},
+};
+
+#define LED_MASK_B (1<<0 | 1<<1 | 1<<4 | 1<<5 | 1<<6 | 1<<7)
+#define LED_MASK_C (1<<5 | 1<<6)
+#define LED_MASK_D (1<<0 | 1<<4 | 1<<5 | 1<<6)
+
+static inline void
+led_ports_init(void)
+{
+    DDRB |= LED_MASK_B;
+    DDRC |= LED_MASK_C;
+    DDRD |= LED_MASK_D;
+}
+
+/*
+ * Light the LEDs in lit[LED_PORTS], turn off the others
+ */
+static inline void
+led_ports_write(const volatile uint8_t *lit)
+{
+    PORTB = (PORTB & ~LED_MASK_B) | lit[LED_PORT_B];
+    PORTC = (PORTC & ~LED_MASK_C) | lit[LED_PORT_C];
+    PORTD = (PORTD & ~LED_MASK_D) | lit[LED_PORT_D];
+}
+
+/*
+ * Light LEDs from to to - 1, turn off the others
+ */
+static inline void
+led_ports_range(uint8_t from, uint8_t to)
+{
+    uint8_t i, lit[LED_PORTS] = {0};
+
+    for (i = from; i < to && i < 12; i++)
+        lit[pgm_read_byte(&led_pins[i].port)] |= pgm_read_byte(&led_pins[i].mask);
+    led_ports_write(lit);
+}
+
+#endif
@@ -20,9 +20,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
  * scan matrix
  */
 
+#include "bench.h"
 #include "debug.h"
+#include "dlog.h"
 #include "matrix.h"
 #include "lufa.h"
+#include "timer.h"
+#include <util/atomic.h>
 #include <util/delay.h>
 
 
@@ -30,6 +34,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 static matrix_row_t matrix[MATRIX_ROWS];
 static matrix_row_t matrix_debouncing[MATRIX_ROWS];
 
+#if PROFILE
+/* Timer1 count around the last scan, for nan-15_chord.c's profiler */
+uint16_t matrix_scan_start, matrix_scan_end;
+#endif
+
 static uint8_t read_rows(void);
 static void init_rows(void);
 static void unselect_cols(void);
@@ -66,14 +75,21 @@ matrix_init(void)
 uint8_t
 matrix_scan(void)
 {
-    static uint8_t debouncing = DEBOUNCE;
+    static bool debouncing = true;
+    static uint16_t last_change = 0;
     uint8_t col;
 
+    bench_start(BENCH_SCAN);
+#if PROFILE
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        matrix_scan_start = TCNT1;
+    }
+#endif
     for (col = 0; col < MATRIX_COLS; col++) {
         uint8_t rows, row;
 
         select_col(col);
-        _delay_us(30);  // without this wait read unstable value.
+        _delay_us(MATRIX_SETTLE_US);  // without this wait read unstable value.
         rows = read_rows();
         for (row = 0; row < MATRIX_ROWS; row++) {
             bool prev_bit = matrix_debouncing[row] & ((matrix_row_t)1<<col);
@@ -81,23 +97,31 @@ matrix_scan(void)
 
             if (prev_bit != curr_bit) {
                 matrix_debouncing[row] ^= ((matrix_row_t)1<<col);
-                if (debouncing)
-                    debug("bounce!: "); debug_hex(debouncing); debug("\n");
-                debouncing = DEBOUNCE;
+                if (debouncing) {
+                    dlog(MATRIX, DLOG_DEBUG, "bounce!: ");
+                    dlog_hex(MATRIX, DLOG_DEBUG, row<<4 | col);
+                    dlog(MATRIX, DLOG_DEBUG, "\n");
+                }
+                debouncing = true;
+                last_change = timer_read();
             }
             unselect_cols();
         }
     }
-    if (debouncing) {
-        if (--debouncing) {
-            _delay_ms(1);
-        } else {
-            uint8_t i;
-
-            for (i = 0; i < MATRIX_ROWS; i++)
-                matrix[i] = matrix_debouncing[i];
-        }
+    /* settled for DEBOUNCE ms */
+    if (debouncing && timer_elapsed(last_change) >= DEBOUNCE) {
+        uint8_t i;
+
+        for (i = 0; i < MATRIX_ROWS; i++)
+            matrix[i] = matrix_debouncing[i];
+        debouncing = false;
+    }
+#if PROFILE
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        matrix_scan_end = TCNT1;
     }
+#endif
+    bench_end(BENCH_SCAN);
     return 1;
 }
 
@@ -107,6 +131,25 @@ matrix_get_row(uint8_t row)
     return matrix[row];
 }
 
+/* Raw matrix access for nan-15_selftest.c and nan-15_chord.c's fast boot */
+void
+matrix_select_col(uint8_t col)
+{
+    select_col(col);
+}
+
+void
+matrix_unselect_cols(void)
+{
+    unselect_cols();
+}
+
+uint8_t
+matrix_read_rows(void)
+{
+    return read_rows();
+}
+
 /* Row pin configuration
  * row: 0  1  2  3
  * pin: B3 B2 D3 C2
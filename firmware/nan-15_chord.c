@@ -19,13 +19,21 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "actionmap.h"
 #include "action_layer.h"
 #include "action_util.h"
+#include "bench.h"
 #include "debug.h"
+#include "dlog.h"
+#include "hook.h"
 #include "host.h"
 #include "led.h"
+#include "leds.h"
+#include "matrix.h"
 #include "timer.h"
 #include "wait.h"
 #include <avr/eeprom.h>
+#include <avr/interrupt.h>
+#include <stddef.h>
 #include <stdio.h>
+#include <util/atomic.h>
 
 
 /*  NaN-15 raw actionmap and LED definition
@@ -81,6 +89,10 @@ enum func_id {
     FNG_CHRD,
     THB_CHRD,
     LAYER_MOMENTARY,
+    /* appended so as not to renumber those stored in EEPROM */
+    TRACE_DUMP,
+    RTT_TEST,
+    NEXT_PROFILE,
 };
 
 /* action_function() dispatches on AF()'s and PF()'s func_id */
@@ -96,6 +108,8 @@ enum layer {
     L_MCR,
     /* sublayers, only accessible from non-chord layers */
     L_NUM_FN,
+    /* overlay keeping the bottom row in chord mode while a layer is held */
+    L_THB_HOLD,
 };
 
 static const action_t actionmaps[][MATRIX_ROWS][MATRIX_COLS] PROGMEM = {
@@ -135,6 +149,12 @@ static const action_t actionmaps[][MATRIX_ROWS][MATRIX_COLS] PROGMEM = {
         {AC_TRNS, AC_TRNS, AC_TRNS, AC_BSPC,},
         {AC_TRNS, AC_NO,   AC_P0,   AC_TRNS,},
     },
+    [L_THB_HOLD] = {               /* bottom row over a held layer */
+        {AC_TRNS,            AC_TRNS, AC_TRNS,            AC_TRNS,           },
+        {AC_TRNS,            AC_TRNS, AC_TRNS,            AC_TRNS,           },
+        {AC_TRNS,            AC_TRNS, AC_TRNS,            AC_TRNS,           },
+        {PF(4, 2, THB_CHRD), AC_NO,   PF(4, 1, THB_CHRD), PF(4, 0, THB_CHRD),},
+    },
 };
 
 #define MCR_LEN 6             /* chords per macro */
@@ -163,7 +183,7 @@ typedef struct {
     uint8_t mods_lo :4;
     uint8_t code_up :8;
     uint8_t mods_up :4;
-} keypair_t;
+} __attribute__((packed)) keypair_t;
 
 /* keypair_t mods:  3210
  *   bit 0          |||+- Left Control
@@ -196,263 +216,51 @@ enum keypair_mod {
 
 /* chrdmap[0].mods_low and chrdmap[0].code_lo are unaccessible */
 static keypair_t chrdmap[256] EEMEM = {
-    [CHRD(0, 0, 0, 0)] = KEYPAIR(   No, NO,             Sh, NO            ),
-    [CHRD(0, 0, 0, 1)] = KEYPAIR(   No, 1,              No, F1            ),
-    [CHRD(0, 0, 0, 2)] = KEYPAIR(   No, 0,              No, F10           ),
-    [CHRD(0, 0, 0, 3)] = KEYPAIR(   No, DOT,            Sh, DOT           ),
-    [CHRD(0, 0, 1, 0)] = KEYPAIR(   No, 2,              No, F2            ),
-    [CHRD(0, 0, 1, 1)] = KEYPAIR(   No, 3,              No, F3            ),
-    [CHRD(0, 0, 1, 2)] = KEYPAIR(   No, Q,              Sh, Q             ),
-    [CHRD(0, 0, 1, 3)] = KEYPAIR(   No, FN4,            No, NO            ),
-    [CHRD(0, 0, 2, 0)] = KEYPAIR(   No, I,              Sh, I             ),
-    [CHRD(0, 0, 2, 1)] = KEYPAIR(   No, Z,              Sh, Z             ),
-    [CHRD(0, 0, 2, 2)] = KEYPAIR(   No, T,              Sh, T             ),
-    [CHRD(0, 0, 2, 3)] = KEYPAIR(   Ag, EQUAL,       Ag|Sh, EQUAL         ),
-    [CHRD(0, 0, 3, 0)] = KEYPAIR(   No, COMMA,          Sh, COMMA         ),
-    [CHRD(0, 0, 3, 1)] = KEYPAIR(   No, FN5,            No, NO            ),
-    [CHRD(0, 0, 3, 2)] = KEYPAIR(   Ag, 7,              Ag, 0             ),
-    [CHRD(0, 0, 3, 3)] = KEYPAIR(   Sh, MINUS,          Sh, 1             ),
-    [CHRD(0, 1, 0, 0)] = KEYPAIR(   No, 4,              No, F4            ),
-    [CHRD(0, 1, 0, 1)] = KEYPAIR(   No, 5,              No, F5            ),
-    [CHRD(0, 1, 0, 2)] = KEYPAIR(   No, UNDO,           No, HELP          ),
-    [CHRD(0, 1, 0, 3)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(0, 1, 1, 0)] = KEYPAIR(   No, 6,              No, F6            ),
-    [CHRD(0, 1, 1, 1)] = KEYPAIR(   No, 7,              No, F7            ),
-    [CHRD(0, 1, 1, 2)] = KEYPAIR(   No, LANG4,          No, INT4          ),
-    [CHRD(0, 1, 1, 3)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(0, 1, 2, 0)] = KEYPAIR(   No, X,              Sh, X             ),
-    [CHRD(0, 1, 2, 1)] = KEYPAIR(   No, KP_ENTER,       No, NO            ),
-    [CHRD(0, 1, 2, 2)] = KEYPAIR(   Ag, LBRACKET,    Ag|Sh, SCOLON        ),
-    [CHRD(0, 1, 2, 3)] = KEYPAIR(   No, KP_6,           No, NO            ),
-    [CHRD(0, 1, 3, 0)] = KEYPAIR(   No, FN2,            No, NO            ),
-    [CHRD(0, 1, 3, 1)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(0, 1, 3, 2)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(0, 1, 3, 3)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(0, 2, 0, 0)] = KEYPAIR(   No, E,              Sh, E             ),
-    [CHRD(0, 2, 0, 1)] = KEYPAIR(   No, GRAVE,          Sh, GRAVE         ),
-    [CHRD(0, 2, 0, 2)] = KEYPAIR(   No, R,              Sh, R             ),
-    [CHRD(0, 2, 0, 3)] = KEYPAIR(   No, QUOTE,          Sh, QUOTE         ),
-    [CHRD(0, 2, 1, 0)] = KEYPAIR(   No, K,              Sh, K             ),
-    [CHRD(0, 2, 1, 1)] = KEYPAIR(   Ag|Sh, 9,        Ag|Sh, 8             ),
-    [CHRD(0, 2, 1, 2)] = KEYPAIR(   No, ESCAPE,         No, PASTE         ),
-    [CHRD(0, 2, 1, 3)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(0, 2, 2, 0)] = KEYPAIR(   No, S,              Sh, S             ),
-    [CHRD(0, 2, 2, 1)] = KEYPAIR(   Ag, 2,           Ag|Sh, 2             ),
-    [CHRD(0, 2, 2, 2)] = KEYPAIR(   No, G,              Sh, G             ),
-    [CHRD(0, 2, 2, 3)] = KEYPAIR(   No, RIGHT,          No, LEFT          ),
-    [CHRD(0, 2, 3, 0)] = KEYPAIR(   Ag, D,           Ag|Sh, D             ),
-    [CHRD(0, 2, 3, 1)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(0, 2, 3, 2)] = KEYPAIR(   No, BSLASH,         Sh, BSLASH        ),
-    [CHRD(0, 2, 3, 3)] = KEYPAIR(   Ag, 5,           Ag|Sh, 5             ),
-    [CHRD(0, 3, 0, 0)] = KEYPAIR(   Sh, 4,              Sh, 3             ),
-    [CHRD(0, 3, 0, 1)] = KEYPAIR(   No, KP_EQUAL,       No, NO            ),
-    [CHRD(0, 3, 0, 2)] = KEYPAIR(   No, KP_DOT,         No, NO            ),
-    [CHRD(0, 3, 0, 3)] = KEYPAIR(   No, SLASH,          Sh, SLASH         ),
-    [CHRD(0, 3, 1, 0)] = KEYPAIR(   No, FN3,            No, NO            ),
-    [CHRD(0, 3, 1, 1)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(0, 3, 1, 2)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(0, 3, 1, 3)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(0, 3, 2, 0)] = KEYPAIR(   Ag, 8,              Ag, 9             ),
-    [CHRD(0, 3, 2, 1)] = KEYPAIR(   No, KP_9,           No, NO            ),
-    [CHRD(0, 3, 2, 2)] = KEYPAIR(   Ag|Sh, COMMA,    Ag|Sh, DOT           ),
-    [CHRD(0, 3, 2, 3)] = KEYPAIR(   No, UP,             No, DOWN          ),
-    [CHRD(0, 3, 3, 0)] = KEYPAIR(   No, SPACE,          No, NO            ),
-    [CHRD(0, 3, 3, 1)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(0, 3, 3, 2)] = KEYPAIR(   Ag, T,           Ag|Sh, T             ),
-    [CHRD(0, 3, 3, 3)] = KEYPAIR(   Sh, 7,              Ag, MINUS         ),
-    [CHRD(1, 0, 0, 0)] = KEYPAIR(   No, 8,              No, F8            ),
-    [CHRD(1, 0, 0, 1)] = KEYPAIR(   No, 9,              No, F9            ),
-    [CHRD(1, 0, 0, 2)] = KEYPAIR(   No, F11,            No, F12           ),
-    [CHRD(1, 0, 0, 3)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(1, 0, 1, 0)] = KEYPAIR(   No, P,              Sh, P             ),
-    [CHRD(1, 0, 1, 1)] = KEYPAIR(   No, D,              Sh, D             ),
-    [CHRD(1, 0, 1, 2)] = KEYPAIR(   Ag, X,              Ag, Z             ),
-    [CHRD(1, 0, 1, 3)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(1, 0, 2, 0)] = KEYPAIR(   No, MINUS,          No, NO            ),
-    [CHRD(1, 0, 2, 1)] = KEYPAIR(   Ag, SLASH,       Ag|Sh, SLASH         ),
-    [CHRD(1, 0, 2, 2)] = KEYPAIR(   Ag, U,           Ag|Sh, U             ),
-    [CHRD(1, 0, 2, 3)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(1, 0, 3, 0)] = KEYPAIR(   No, FN6,            No, NO            ),
-    [CHRD(1, 0, 3, 1)] = KEYPAIR(   Ag, BSLASH,         No, NO            ),
-    [CHRD(1, 0, 3, 2)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(1, 0, 3, 3)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(1, 1, 0, 0)] = KEYPAIR(   No, C,              Sh, C             ),
-    [CHRD(1, 1, 0, 1)] = KEYPAIR(   No, B,              Sh, B             ),
-    [CHRD(1, 1, 0, 2)] = KEYPAIR(   No, KP_ASTERISK,    No, NO            ),
-    [CHRD(1, 1, 0, 3)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(1, 1, 1, 0)] = KEYPAIR(   No, W,              Sh, W             ),
-    [CHRD(1, 1, 1, 1)] = KEYPAIR(   No, Y,              Sh, Y             ),
-    [CHRD(1, 1, 1, 2)] = KEYPAIR(   No, KP_1,           No, NO            ),
-    [CHRD(1, 1, 1, 3)] = KEYPAIR(   No, NO,          Ag|Sh, E             ),
-    [CHRD(1, 1, 2, 0)] = KEYPAIR(   No, KP_3,           No, NO            ),
-    [CHRD(1, 1, 2, 1)] = KEYPAIR(   No, KP_4,           No, NO            ),
-    [CHRD(1, 1, 2, 2)] = KEYPAIR(   No, KP_5,           No, NO            ),
-    [CHRD(1, 1, 2, 3)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(1, 1, 3, 0)] = KEYPAIR(   No, KP_7,           No, NO            ),
-    [CHRD(1, 1, 3, 1)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(1, 1, 3, 2)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(1, 1, 3, 3)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(1, 2, 0, 0)] = KEYPAIR(   No, V,              Sh, V             ),
-    [CHRD(1, 2, 0, 1)] = KEYPAIR(   Ag, NONUS_HASH,  Ag|Sh, NONUS_HASH    ),
-    [CHRD(1, 2, 0, 2)] = KEYPAIR(   No, APPLICATION,    No, NO            ),
-    [CHRD(1, 2, 0, 3)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(1, 2, 1, 0)] = KEYPAIR(Ag|Sh, X,           Ag|Sh, Z             ),
-    [CHRD(1, 2, 1, 1)] = KEYPAIR(   No, F13,            No, F14           ),
-    [CHRD(1, 2, 1, 2)] = KEYPAIR(   No, F15,            No, F16           ),
-    [CHRD(1, 2, 1, 3)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(1, 2, 2, 0)] = KEYPAIR(   Ag, Y,              Ag, I             ),
-    [CHRD(1, 2, 2, 1)] = KEYPAIR(   No, F17,            No, F18           ),
-    [CHRD(1, 2, 2, 2)] = KEYPAIR(   No, F19,            No, F20           ),
-    [CHRD(1, 2, 2, 3)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(1, 2, 3, 0)] = KEYPAIR(   No, F21,            No, F22           ),
-    [CHRD(1, 2, 3, 1)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(1, 2, 3, 2)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(1, 2, 3, 3)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(1, 3, 0, 0)] = KEYPAIR(   No, FN0,            No, NO            ),
-    [CHRD(1, 3, 0, 1)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(1, 3, 0, 2)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(1, 3, 0, 3)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(1, 3, 1, 0)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(1, 3, 1, 1)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(1, 3, 1, 2)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(1, 3, 1, 3)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(1, 3, 2, 0)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(1, 3, 2, 1)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(1, 3, 2, 2)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(1, 3, 2, 3)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(1, 3, 3, 0)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(1, 3, 3, 1)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(1, 3, 3, 2)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(1, 3, 3, 3)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(2, 0, 0, 0)] = KEYPAIR(   No, A,              Sh, A             ),
-    [CHRD(2, 0, 0, 1)] = KEYPAIR(   Ag, W,           Ag|Sh, W             ),
-    [CHRD(2, 0, 0, 2)] = KEYPAIR(   No, N,              Sh, N             ),
-    [CHRD(2, 0, 0, 3)] = KEYPAIR(   Ag, 4,           Ag|Sh, 4             ),
-    [CHRD(2, 0, 1, 0)] = KEYPAIR(   No, SCOLON,         Sh, SCOLON        ),
-    [CHRD(2, 0, 1, 1)] = KEYPAIR(   Ag, C,           Ag|Sh, C             ),
-    [CHRD(2, 0, 1, 2)] = KEYPAIR(   Ag, GRAVE,       Ag|Sh, GRAVE         ),
-    [CHRD(2, 0, 1, 3)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(2, 0, 2, 0)] = KEYPAIR(   No, O,              Sh, O             ),
-    [CHRD(2, 0, 2, 1)] = KEYPAIR(   Ag, 6,           Ag|Sh, 6             ),
-    [CHRD(2, 0, 2, 2)] = KEYPAIR(   No, U,              Sh, U             ),
-    [CHRD(2, 0, 2, 3)] = KEYPAIR(   Ag, G,           Ag|Sh, G             ),
-    [CHRD(2, 0, 3, 0)] = KEYPAIR(   Ag, P,           Ag|Sh, P             ),
-    [CHRD(2, 0, 3, 1)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(2, 0, 3, 2)] = KEYPAIR(   No, LANG2,          No, INT2          ),
-    [CHRD(2, 0, 3, 3)] = KEYPAIR(   No, LANG3,          No, INT3          ),
-    [CHRD(2, 1, 0, 0)] = KEYPAIR(   No, J,              Sh, J             ),
-    [CHRD(2, 1, 0, 1)] = KEYPAIR(   No, LANG5,          No, INT5          ),
-    [CHRD(2, 1, 0, 2)] = KEYPAIR(   No, LANG6,          No, INT6          ),
-    [CHRD(2, 1, 0, 3)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(2, 1, 1, 0)] = KEYPAIR(   No, LANG8,          No, INT8          ),
-    [CHRD(2, 1, 1, 1)] = KEYPAIR(   No, LANG9,          No, INT9          ),
-    [CHRD(2, 1, 1, 2)] = KEYPAIR(   No, _MUTE,          No, PAUSE         ),
-    [CHRD(2, 1, 1, 3)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(2, 1, 2, 0)] = KEYPAIR(   No, PSCREEN,        No, SYSREQ        ),
-    [CHRD(2, 1, 2, 1)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(2, 1, 2, 2)] = KEYPAIR(   No, LANG7,          No, INT7          ),
-    [CHRD(2, 1, 2, 3)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(2, 1, 3, 0)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(2, 1, 3, 1)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(2, 1, 3, 2)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(2, 1, 3, 3)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(2, 2, 0, 0)] = KEYPAIR(   No, L,              Sh, L             ),
-    [CHRD(2, 2, 0, 1)] = KEYPAIR(   Ag, K,           Ag|Sh, K             ),
-    [CHRD(2, 2, 0, 2)] = KEYPAIR(   No, M,              Sh, M             ),
-    [CHRD(2, 2, 0, 3)] = KEYPAIR(   No, STOP,           Ag, E             ),
-    [CHRD(2, 2, 1, 0)] = KEYPAIR(   No, KP_0,           No, NO            ),
-    [CHRD(2, 2, 1, 1)] = KEYPAIR(   No, KP_8,           No, POWER         ),
-    [CHRD(2, 2, 1, 2)] = KEYPAIR(   No, KP_2,           No, NO            ),
-    [CHRD(2, 2, 1, 3)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(2, 2, 2, 0)] = KEYPAIR(   No, F,              Sh, F             ),
-    [CHRD(2, 2, 2, 1)] = KEYPAIR(   No, KP_SLASH,       No, NO            ),
-    [CHRD(2, 2, 2, 2)] = KEYPAIR(   No, H,              Sh, H             ),
-    [CHRD(2, 2, 2, 3)] = KEYPAIR(   Ag, S,           Ag|Sh, S             ),
-    [CHRD(2, 2, 3, 0)] = KEYPAIR(   Ag, H,           Ag|Sh, H             ),
-    [CHRD(2, 2, 3, 1)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(2, 2, 3, 2)] = KEYPAIR(   Ag, R,           Ag|Sh, R             ),
-    [CHRD(2, 2, 3, 3)] = KEYPAIR(   Ag, Q,           Ag|Sh, Q             ),
-    [CHRD(2, 3, 0, 0)] = KEYPAIR(   No, NONUS_BSLASH,   Sh, NONUS_BSLASH  ),
-    [CHRD(2, 3, 0, 1)] = KEYPAIR(   Ag, Y,           Ag|Sh, Y             ),
-    [CHRD(2, 3, 0, 2)] = KEYPAIR(   Ag, 3,           Ag|Sh, 3             ),
-    [CHRD(2, 3, 0, 3)] = KEYPAIR(   Ag, DOT,            Ag, COMMA         ),
-    [CHRD(2, 3, 1, 0)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(2, 3, 1, 1)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(2, 3, 1, 2)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(2, 3, 1, 3)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(2, 3, 2, 0)] = KEYPAIR(   No, _VOLDOWN,       No, _VOLUP        ),
-    [CHRD(2, 3, 2, 1)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(2, 3, 2, 2)] = KEYPAIR(   No, INSERT,      Ag|Sh, BSLASH        ),
-    [CHRD(2, 3, 2, 3)] = KEYPAIR(   Ag, O,           Ag|Sh, O             ),
-    [CHRD(2, 3, 3, 0)] = KEYPAIR(   Ag, 1,           Ag|Sh, 1             ),
-    [CHRD(2, 3, 3, 1)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(2, 3, 3, 2)] = KEYPAIR(   Ag, N,           Ag|Sh, N             ),
-    [CHRD(2, 3, 3, 3)] = KEYPAIR(   Ag, M,           Ag|Sh, M             ),
-    [CHRD(3, 0, 0, 0)] = KEYPAIR(   No, NONUS_HASH,     Sh, NONUS_HASH    ),
-    [CHRD(3, 0, 0, 1)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(3, 0, 0, 2)] = KEYPAIR(   No, KP_COMMA,    Ag|Sh, 7             ),
-    [CHRD(3, 0, 0, 3)] = KEYPAIR(   No, ENTER,          No, NO            ),
-    [CHRD(3, 0, 1, 0)] = KEYPAIR(   No, FN7,            No, NO            ),
-    [CHRD(3, 0, 1, 1)] = KEYPAIR(   No, NO,          Ag|Sh, 0             ),
-    [CHRD(3, 0, 1, 2)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(3, 0, 1, 3)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(3, 0, 2, 0)] = KEYPAIR(   No, LBRACKET,       Sh, LBRACKET      ),
-    [CHRD(3, 0, 2, 1)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(3, 0, 2, 2)] = KEYPAIR(   Ag, A,           Ag|Sh, A             ),
-    [CHRD(3, 0, 2, 3)] = KEYPAIR(Ag|Sh, NONUS_BSLASH,Ag|Sh, MINUS         ),
-    [CHRD(3, 0, 3, 0)] = KEYPAIR(   No, TAB,            Sh, TAB           ),
-    [CHRD(3, 0, 3, 1)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(3, 0, 3, 2)] = KEYPAIR(   No, AGAIN,       Ag|Sh, RBRACKET      ),
-    [CHRD(3, 0, 3, 3)] = KEYPAIR(   No, EQUAL,          Sh, EQUAL         ),
-    [CHRD(3, 1, 0, 0)] = KEYPAIR(   No, FN1,            No, NO            ),
-    [CHRD(3, 1, 0, 1)] = KEYPAIR(   Ag, SCOLON,      Ag|Sh, LBRACKET      ),
-    [CHRD(3, 1, 0, 2)] = KEYPAIR(   Ag, QUOTE,       Ag|Sh, QUOTE         ),
-    [CHRD(3, 1, 0, 3)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(3, 1, 1, 0)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(3, 1, 1, 1)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(3, 1, 1, 2)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(3, 1, 1, 3)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(3, 1, 2, 0)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(3, 1, 2, 1)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(3, 1, 2, 2)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(3, 1, 2, 3)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(3, 1, 3, 0)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(3, 1, 3, 1)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(3, 1, 3, 2)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(3, 1, 3, 3)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(3, 2, 0, 0)] = KEYPAIR(   Sh, 8,              Sh, 9             ),
-    [CHRD(3, 2, 0, 1)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(3, 2, 0, 2)] = KEYPAIR(   Ag, V,           Ag|Sh, V             ),
-    [CHRD(3, 2, 0, 3)] = KEYPAIR(   Sh, 5,              Sh, 6             ),
-    [CHRD(3, 2, 1, 0)] = KEYPAIR(   No, KP_MINUS,       No, KP_PLUS       ),
-    [CHRD(3, 2, 1, 1)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(3, 2, 1, 2)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(3, 2, 1, 3)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(3, 2, 2, 0)] = KEYPAIR(   No, HOME,           No, END           ),
-    [CHRD(3, 2, 2, 1)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(3, 2, 2, 2)] = KEYPAIR(   Ag, L,           Ag|Sh, L             ),
-    [CHRD(3, 2, 2, 3)] = KEYPAIR(   No, PGUP,           No, PGDOWN        ),
-    [CHRD(3, 2, 3, 0)] = KEYPAIR(   Ag, B,           Ag|Sh, B             ),
-    [CHRD(3, 2, 3, 1)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(3, 2, 3, 2)] = KEYPAIR(   Ag, J,           Ag|Sh, J             ),
-    [CHRD(3, 2, 3, 3)] = KEYPAIR(Ag|Sh, Y,           Ag|Sh, I             ),
-    [CHRD(3, 3, 0, 0)] = KEYPAIR(   No, RBRACKET,       Sh, RBRACKET      ),
-    [CHRD(3, 3, 0, 1)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(3, 3, 0, 2)] = KEYPAIR(   Ag, F,           Ag|Sh, F             ),
-    [CHRD(3, 3, 0, 3)] = KEYPAIR(   Sh, 0,              Sh, 2             ),
-    [CHRD(3, 3, 1, 0)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(3, 3, 1, 1)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(3, 3, 1, 2)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(3, 3, 1, 3)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(3, 3, 2, 0)] = KEYPAIR(   No, F23,            No, F24           ),
-    [CHRD(3, 3, 2, 1)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(3, 3, 2, 2)] = KEYPAIR(   No, FIND,           No, NO            ),
-    [CHRD(3, 3, 2, 3)] = KEYPAIR(   No, COPY,           No, CUT           ),
-    [CHRD(3, 3, 3, 0)] = KEYPAIR(   Ag, NONUS_BSLASH,   Ag, RBRACKET      ),
-    [CHRD(3, 3, 3, 1)] = KEYPAIR(   No, NO,             No, NO            ),
-    [CHRD(3, 3, 3, 2)] = KEYPAIR(   No, LANG1,          No, INT1          ),
-    [CHRD(3, 3, 3, 3)] = KEYPAIR(   No, BSPACE,         No, DELETE        ),
+#include "chrdmap.h"
+};
+
+#if CHRDMAP_PROFILES > 1
+/*
+ * Complete chordmaps in flash, selectable by chord instead of
+ * rewriting EEPROM.  Profile 0 is chrdmap above.  fn_chrdmap, along
+ * with the macros it holds, is shared by all profiles.  A layout added
+ * here raises CHRDMAP_PROFILES_DEFINED.
+ */
+#define CHRDMAP_PROFILES_DEFINED 2
+#if CHRDMAP_PROFILES > CHRDMAP_PROFILES_DEFINED
+#error "CHRDMAP_PROFILES exceeds the layouts in chrdmap_profile[]"
+#endif
+#if CHRDMAP_PROFILES > 4
+#error "CHRDMAP_PROFILES exceeds the profile LED sets"
+#endif
+static const keypair_t chrdmap_profile[CHRDMAP_PROFILES - 1][256] PROGMEM = {
+    {                           /* 1: factory copy of chrdmap */
+#include "chrdmap.h"
+    },
 };
+#endif
+
+#if ORD_CHRDS
+/*
+ * Finger chords taking a different keypair when the key in column
+ * FIRST (0 = leftmost) is pressed before the others.  Kept in flash
+ * as EEPROM is full, hence not swappable.  The samples below use
+ * chords chrdmap leaves unmapped.
+ */
+typedef struct {
+    uint8_t chrd;
+    uint8_t first;
+    keypair_t keypair;
+} ord_chrd_t;
+
+static const ord_chrd_t ord_chrdmap[] PROGMEM = {
+    {CHRD(0, 1, 0, 3), 3, KEYPAIR(  No, BSPACE,         No, DELETE        )},
+    {CHRD(1, 0, 0, 3), 3, KEYPAIR(  No, TAB,            Sh, TAB           )},
+    {CHRD(3, 0, 0, 1), 0, KEYPAIR(  No, ENTER,          Sh, ENTER         )},
+};
+
+#define ORD_CHRDMAP_LEN (sizeof(ord_chrdmap) / sizeof(ord_chrd_t))
+#endif
 
 /*
  * Keychords comprising a THB_ACTION(n)-mapped thumb chord FN and
@@ -497,14 +305,26 @@ static action_t fn_chrdmap[128] EEMEM = {
     /* hole: 0x30 */
     [FN_CHRD(0, 3, 0b0001)] = AF(L_MCR, CHG_LAYER),
     [FN_CHRD(0, 3, 0b0010)] = AF(L_MSE, CHG_LAYER),
+#if TRACE_LEN
+    [FN_CHRD(0, 3, 0b0011)] = AF(0, TRACE_DUMP),
+#else
     [FN_CHRD(0, 3, 0b0011)] = AC_NO,
+#endif
     [FN_CHRD(0, 3, 0b0100)] = AF(L_NAV, CHG_LAYER),
     [FN_CHRD(0, 3, 0b0101)] = AF(0, PRINT),
     [FN_CHRD(0, 3, 0b0110)] = AF(0, SWAP_CHRDS),
     [FN_CHRD(0, 3, 0b0111)] = AC_CAPSLOCK,
     [FN_CHRD(0, 3, 0b1000)] = AF(L_NUM, CHG_LAYER),
+#if CHRDMAP_PROFILES > 1
+    [FN_CHRD(0, 3, 0b1001)] = AF(0, NEXT_PROFILE),
+#else
     [FN_CHRD(0, 3, 0b1001)] = AC_NO,
+#endif
+#if RTT_ROUNDS
+    [FN_CHRD(0, 3, 0b1010)] = AF(0, RTT_TEST),
+#else
     [FN_CHRD(0, 3, 0b1010)] = AC_NO,
+#endif
     [FN_CHRD(0, 3, 0b1011)] = AC_SCROLLLOCK,
     [FN_CHRD(0, 3, 0b1100)] = AC_NO,
     [FN_CHRD(0, 3, 0b1101)] = AC_NO,
@@ -546,14 +366,26 @@ static action_t fn_chrdmap[128] EEMEM = {
     /* hole: 0x70 */
     [FN_CHRD(1, 3, 0b0001)] = AF(L_MCR, CHG_LAYER),
     [FN_CHRD(1, 3, 0b0010)] = AF(L_MSE, CHG_LAYER),
+#if TRACE_LEN
+    [FN_CHRD(1, 3, 0b0011)] = AF(0, TRACE_DUMP),
+#else
     [FN_CHRD(1, 3, 0b0011)] = AC_NO,
+#endif
     [FN_CHRD(1, 3, 0b0100)] = AF(L_NAV, CHG_LAYER),
     [FN_CHRD(1, 3, 0b0101)] = AF(0, PRINT),
     [FN_CHRD(1, 3, 0b0110)] = AF(0, SWAP_CHRDS),
     [FN_CHRD(1, 3, 0b0111)] = AC_CAPSLOCK,
     [FN_CHRD(1, 3, 0b1000)] = AF(L_NUM, CHG_LAYER),
+#if CHRDMAP_PROFILES > 1
+    [FN_CHRD(1, 3, 0b1001)] = AF(0, NEXT_PROFILE),
+#else
     [FN_CHRD(1, 3, 0b1001)] = AC_NO,
+#endif
+#if RTT_ROUNDS
+    [FN_CHRD(1, 3, 0b1010)] = AF(0, RTT_TEST),
+#else
     [FN_CHRD(1, 3, 0b1010)] = AC_NO,
+#endif
     [FN_CHRD(1, 3, 0b1011)] = AC_SCROLLLOCK,
     [FN_CHRD(1, 3, 0b1100)] = AC_NO,
     [FN_CHRD(1, 3, 0b1101)] = AC_NO,
@@ -580,6 +412,8 @@ static const uint8_t fn_chrdmap_holes[36] PROGMEM = {
 
 /*
  * Keychords on the bottom row.  Not stored in EEPROM; immutable.
+ * AF(layer, LAYER_MOMENTARY) overlays layer for as long as the chord
+ * is held, provided no finger key was pressed before.
  */
 #define ACT_THB_CHRD ACT_MODS_TAP
 #define THB_CHRD(FN1, UPPER, FN2) ((FN1) | ((UPPER)<<1) | ((FN2)<<2))
@@ -590,10 +424,10 @@ static const action_t thb_chrdmap[8] PROGMEM = {
     [THB_CHRD(0, 0, 0)] = AC_NO, /* unreachable */
     [THB_CHRD(0, 0, 1)] = THB_ACTION(0),
     [THB_CHRD(0, 1, 0)] = {.code = THB_UP},
-    [THB_CHRD(0, 1, 1)] = AC_NO,
+    [THB_CHRD(0, 1, 1)] = AF(L_NUM, LAYER_MOMENTARY),
     [THB_CHRD(1, 0, 0)] = THB_ACTION(1),
     [THB_CHRD(1, 0, 1)] = AC_ESCAPE,
-    [THB_CHRD(1, 1, 0)] = AC_NO,
+    [THB_CHRD(1, 1, 0)] = AF(L_NAV, LAYER_MOMENTARY),
     [THB_CHRD(1, 1, 1)] = AF(0, RESET),
   };
 
@@ -601,262 +435,522 @@ static const action_t thb_chrdmap[8] PROGMEM = {
 /*************************************************************
  * Human-readable names of the keycodes
  *************************************************************/
+/*
+ * Each table is a string pool in flash, laid out by the compiler as a
+ * struct of char arrays sized to fit, plus the names' offsets into it.
+ * Codes without a name get the empty string at offset 0.
+ */
 #define CODE_NAME_LEN 9
-static const char code_name[][CODE_NAME_LEN + 1] PROGMEM = {
-    [KC_NO]                  = "no",
-    [KC_ROLL_OVER]           = "roll_over",
-    [KC_POST_FAIL]           = "post_fail",
-    [KC_UNDEFINED]           = "undefined",
-    [KC_A]                   = "a",
-    [KC_B]                   = "b",
-    [KC_C]                   = "c",
-    [KC_D]                   = "d",
-    [KC_E]                   = "e",
-    [KC_F]                   = "f",
-    [KC_G]                   = "g",
-    [KC_H]                   = "h",
-    [KC_I]                   = "i",
-    [KC_J]                   = "j",
-    [KC_K]                   = "k",
-    [KC_L]                   = "l",
-    [KC_M]                   = "m",
-    [KC_N]                   = "n",
-    [KC_O]                   = "o",
-    [KC_P]                   = "p",
-    [KC_Q]                   = "q",
-    [KC_R]                   = "r",
-    [KC_S]                   = "s",
-    [KC_T]                   = "t",
-    [KC_U]                   = "u",
-    [KC_V]                   = "v",
-    [KC_W]                   = "w",
-    [KC_X]                   = "x",
-    [KC_Y]                   = "y",
-    [KC_Z]                   = "z",
-    [KC_1]                   = "1",
-    [KC_2]                   = "2",
-    [KC_3]                   = "3",
-    [KC_4]                   = "4",
-    [KC_5]                   = "5",
-    [KC_6]                   = "6",
-    [KC_7]                   = "7",
-    [KC_8]                   = "8",
-    [KC_9]                   = "9",
-    [KC_0]                   = "0",
-    [KC_ENTER]               = "enter",
-    [KC_ESCAPE]              = "escape",
-    [KC_BSPACE]              = "bspace",
-    [KC_TAB]                 = "tab",
-    [KC_SPACE]               = "space",
-    [KC_MINUS]               = "minus",
-    [KC_EQUAL]               = "equal",
-    [KC_LBRACKET]            = "lbracket",
-    [KC_RBRACKET]            = "rbracket",
-    [KC_BSLASH]              = "bslash",
-    [KC_NONUS_HASH]          = "nus_hash",
-    [KC_SCOLON]              = "scolon",
-    [KC_QUOTE]               = "quote",
-    [KC_GRAVE]               = "grave",
-    [KC_COMMA]               = "comma",
-    [KC_DOT]                 = "dot",
-    [KC_SLASH]               = "slash",
-    [KC_CAPSLOCK]            = "capslock",
-    [KC_F1]                  = "f1",
-    [KC_F2]                  = "f2",
-    [KC_F3]                  = "f3",
-    [KC_F4]                  = "f4",
-    [KC_F5]                  = "f5",
-    [KC_F6]                  = "f6",
-    [KC_F7]                  = "f7",
-    [KC_F8]                  = "f8",
-    [KC_F9]                  = "f9",
-    [KC_F10]                 = "f10",
-    [KC_F11]                 = "f11",
-    [KC_F12]                 = "f12",
-    [KC_PSCREEN]             = "pscreen",
-    [KC_SCROLLLOCK]          = "scrolllck",
-    [KC_PAUSE]               = "pause",
-    [KC_INSERT]              = "insert",
-    [KC_HOME]                = "home",
-    [KC_PGUP]                = "pgup",
-    [KC_DELETE]              = "delete",
-    [KC_END]                 = "end",
-    [KC_PGDOWN]              = "pgdown",
-    [KC_RIGHT]               = "right",
-    [KC_LEFT]                = "left",
-    [KC_DOWN]                = "down",
-    [KC_UP]                  = "up",
-    [KC_NUMLOCK]             = "numlock",
-    [KC_KP_SLASH]            = "kp_slash",
-    [KC_KP_ASTERISK]         = "kp_aster",
-    [KC_KP_MINUS]            = "kp_minus",
-    [KC_KP_PLUS]             = "kp_plus",
-    [KC_KP_ENTER]            = "kp_enter",
-    [KC_KP_1]                = "kp_1",
-    [KC_KP_2]                = "kp_2",
-    [KC_KP_3]                = "kp_3",
-    [KC_KP_4]                = "kp_4",
-    [KC_KP_5]                = "kp_5",
-    [KC_KP_6]                = "kp_6",
-    [KC_KP_7]                = "kp_7",
-    [KC_KP_8]                = "kp_8",
-    [KC_KP_9]                = "kp_9",
-    [KC_KP_0]                = "kp_0",
-    [KC_KP_DOT]              = "kp_dot",
-    [KC_NONUS_BSLASH]        = "nus_bslsh",
-    [KC_APPLICATION]         = "appl",
-    [KC_POWER]               = "power",
-    [KC_KP_EQUAL]            = "kp_equal",
-    [KC_F13]                 = "f13",
-    [KC_F14]                 = "f14",
-    [KC_F15]                 = "f15",
-    [KC_F16]                 = "f16",
-    [KC_F17]                 = "f17",
-    [KC_F18]                 = "f18",
-    [KC_F19]                 = "f19",
-    [KC_F20]                 = "f20",
-    [KC_F21]                 = "f21",
-    [KC_F22]                 = "f22",
-    [KC_F23]                 = "f23",
-    [KC_F24]                 = "f24",
-    [KC_EXECUTE]             = "execute",
-    [KC_HELP]                = "help",
-    [KC_MENU]                = "menu",
-    [KC_SELECT]              = "select",
-    [KC_STOP]                = "stop",
-    [KC_AGAIN]               = "again",
-    [KC_UNDO]                = "undo",
-    [KC_CUT]                 = "cut",
-    [KC_COPY]                = "copy",
-    [KC_PASTE]               = "paste",
-    [KC_FIND]                = "find",
-    [KC__MUTE]               = "mute",
-    [KC__VOLUP]              = "volup",
-    [KC__VOLDOWN]            = "voldown",
-    [KC_LOCKING_CAPS]        = "lck_caps",
-    [KC_LOCKING_NUM]         = "lck_num",
-    [KC_LOCKING_SCROLL]      = "lck_scrll",
-    [KC_KP_COMMA]            = "kp_comma",
-    [KC_KP_EQUAL_AS400]      = "kp_eq_as4",
-    [KC_INT1]                = "int1",
-    [KC_INT2]                = "int2",
-    [KC_INT3]                = "int3",
-    [KC_INT4]                = "int4",
-    [KC_INT5]                = "int5",
-    [KC_INT6]                = "int6",
-    [KC_INT7]                = "int7",
-    [KC_INT8]                = "int8",
-    [KC_INT9]                = "int9",
-    [KC_LANG1]               = "lang1",
-    [KC_LANG2]               = "lang2",
-    [KC_LANG3]               = "lang3",
-    [KC_LANG4]               = "lang4",
-    [KC_LANG5]               = "lang5",
-    [KC_LANG6]               = "lang6",
-    [KC_LANG7]               = "lang7",
-    [KC_LANG8]               = "lang8",
-    [KC_LANG9]               = "lang9",
-    [KC_ALT_ERASE]           = "alt_erase",
-    [KC_SYSREQ]              = "sysreq",
-    [KC_CANCEL]              = "cancel",
-    [KC_CLEAR]               = "clear",
-    [KC_PRIOR]               = "prior",
-    [KC_RETURN]              = "return",
-    [KC_SEPARATOR]           = "separator",
-    [KC_OUT]                 = "out",
-    [KC_OPER]                = "oper",
-    [KC_CLEAR_AGAIN]         = "clr_again",
-    [KC_CRSEL]               = "crsel",
-    [KC_EXSEL]               = "exsel",
-    [KC_KP_00]               = "kp_00",
-    [KC_KP_000]              = "kp_000",
-    [KC_THOUSANDS_SEPARATOR] = "1000s_sep",
-    [KC_DECIMAL_SEPARATOR]   = "dec_sep",
-    [KC_CURRENCY_UNIT]       = "cur_unit",
-    [KC_CURRENCY_SUB_UNIT]   = "c_subunit",
-    [KC_KP_LPAREN]           = "kp_lparen",
-    [KC_KP_RPAREN]           = "kp_rparen",
-    [KC_KP_LCBRACKET]        = "kp_lcbrck",
-    [KC_KP_RCBRACKET]        = "kp_rcbrck",
-    [KC_KP_TAB]              = "kp_tab",
-    [KC_KP_BSPACE]           = "kp_bspace",
-    [KC_KP_A]                = "kp_a",
-    [KC_KP_B]                = "kp_b",
-    [KC_KP_C]                = "kp_c",
-    [KC_KP_D]                = "kp_d",
-    [KC_KP_E]                = "kp_e",
-    [KC_KP_F]                = "kp_f",
-    [KC_KP_XOR]              = "kp_xor",
-    [KC_KP_HAT]              = "kp_hat",
-    [KC_KP_PERC]             = "kp_perc",
-    [KC_KP_LT]               = "kp_lt",
-    [KC_KP_GT]               = "kp_gt",
-    [KC_KP_AND]              = "kp_and",
-    [KC_KP_LAZYAND]          = "kp_lzyand",
-    [KC_KP_OR]               = "kp_or",
-    [KC_KP_LAZYOR]           = "kp_lazyor",
-    [KC_KP_COLON]            = "kp_colon",
-    [KC_KP_HASH]             = "kp_hash",
-    [KC_KP_SPACE]            = "kp_space",
-    [KC_KP_ATMARK]           = "kp_atmark",
-    [KC_KP_EXCLAMATION]      = "kp_exclam",
-    [KC_KP_MEM_STORE]        = "kp_m_sto",
-    [KC_KP_MEM_RECALL]       = "kp_m_rcl",
-    [KC_KP_MEM_CLEAR]        = "kp_m_clr",
-    [KC_KP_MEM_ADD]          = "kp_m_add",
-    [KC_KP_MEM_SUB]          = "kp_m_sub",
-    [KC_KP_MEM_MUL]          = "kp_m_mul",
-    [KC_KP_MEM_DIV]          = "kp_m_div",
-    [KC_KP_PLUS_MINUS]       = "kp_plu_mi",
-    [KC_KP_CLEAR]            = "kp_clr",
-    [KC_KP_CLEAR_ENTRY]      = "kp_clr_en",
-    [KC_KP_BINARY]           = "kp_binary",
-    [KC_KP_OCTAL]            = "kp_octal",
-    [KC_KP_DECIMAL]          = "kp_dec",
-    [KC_KP_HEXADECIMAL]      = "kp_hex",
-    [KC_LCTRL]               = "lctrl",
-    [KC_LSHIFT]              = "lshift",
-    [KC_LALT]                = "lalt",
-    [KC_LGUI]                = "lgui",
-    [KC_RCTRL]               = "rctrl",
-    [KC_RSHIFT]              = "rshift",
-    [KC_RALT]                = "ralt",
-    [KC_RGUI]                = "rgui",
-    [KC_FN0]                 = "macro_0",
-    [KC_FN1]                 = "macro_1",
-    [KC_FN2]                 = "macro_2",
-    [KC_FN3]                 = "macro_3",
-    [KC_FN4]                 = "macro_4",
-    [KC_FN5]                 = "macro_5",
-    [KC_FN6]                 = "macro_6",
-    [KC_FN7]                 = "macro_7",
+#define NAME_MEMBER(id, name) \
+    char id[sizeof(name) <= CODE_NAME_LEN + 1 ? sizeof(name) : -1];
+#define NAME_STRING(id, name) name,
+#define NAME_P(table, i) \
+    name_P(&table##s, table##_offset, \
+           sizeof(table##_offset) / sizeof(uint16_t), (i))
+
+#define CODE_NAMES(X) \
+    X(KC_NO,                  "no") \
+    X(KC_ROLL_OVER,           "roll_over") \
+    X(KC_POST_FAIL,           "post_fail") \
+    X(KC_UNDEFINED,           "undefined") \
+    X(KC_A,                   "a") \
+    X(KC_B,                   "b") \
+    X(KC_C,                   "c") \
+    X(KC_D,                   "d") \
+    X(KC_E,                   "e") \
+    X(KC_F,                   "f") \
+    X(KC_G,                   "g") \
+    X(KC_H,                   "h") \
+    X(KC_I,                   "i") \
+    X(KC_J,                   "j") \
+    X(KC_K,                   "k") \
+    X(KC_L,                   "l") \
+    X(KC_M,                   "m") \
+    X(KC_N,                   "n") \
+    X(KC_O,                   "o") \
+    X(KC_P,                   "p") \
+    X(KC_Q,                   "q") \
+    X(KC_R,                   "r") \
+    X(KC_S,                   "s") \
+    X(KC_T,                   "t") \
+    X(KC_U,                   "u") \
+    X(KC_V,                   "v") \
+    X(KC_W,                   "w") \
+    X(KC_X,                   "x") \
+    X(KC_Y,                   "y") \
+    X(KC_Z,                   "z") \
+    X(KC_1,                   "1") \
+    X(KC_2,                   "2") \
+    X(KC_3,                   "3") \
+    X(KC_4,                   "4") \
+    X(KC_5,                   "5") \
+    X(KC_6,                   "6") \
+    X(KC_7,                   "7") \
+    X(KC_8,                   "8") \
+    X(KC_9,                   "9") \
+    X(KC_0,                   "0") \
+    X(KC_ENTER,               "enter") \
+    X(KC_ESCAPE,              "escape") \
+    X(KC_BSPACE,              "bspace") \
+    X(KC_TAB,                 "tab") \
+    X(KC_SPACE,               "space") \
+    X(KC_MINUS,               "minus") \
+    X(KC_EQUAL,               "equal") \
+    X(KC_LBRACKET,            "lbracket") \
+    X(KC_RBRACKET,            "rbracket") \
+    X(KC_BSLASH,              "bslash") \
+    X(KC_NONUS_HASH,          "nus_hash") \
+    X(KC_SCOLON,              "scolon") \
+    X(KC_QUOTE,               "quote") \
+    X(KC_GRAVE,               "grave") \
+    X(KC_COMMA,               "comma") \
+    X(KC_DOT,                 "dot") \
+    X(KC_SLASH,               "slash") \
+    X(KC_CAPSLOCK,            "capslock") \
+    X(KC_F1,                  "f1") \
+    X(KC_F2,                  "f2") \
+    X(KC_F3,                  "f3") \
+    X(KC_F4,                  "f4") \
+    X(KC_F5,                  "f5") \
+    X(KC_F6,                  "f6") \
+    X(KC_F7,                  "f7") \
+    X(KC_F8,                  "f8") \
+    X(KC_F9,                  "f9") \
+    X(KC_F10,                 "f10") \
+    X(KC_F11,                 "f11") \
+    X(KC_F12,                 "f12") \
+    X(KC_PSCREEN,             "pscreen") \
+    X(KC_SCROLLLOCK,          "scrolllck") \
+    X(KC_PAUSE,               "pause") \
+    X(KC_INSERT,              "insert") \
+    X(KC_HOME,                "home") \
+    X(KC_PGUP,                "pgup") \
+    X(KC_DELETE,              "delete") \
+    X(KC_END,                 "end") \
+    X(KC_PGDOWN,              "pgdown") \
+    X(KC_RIGHT,               "right") \
+    X(KC_LEFT,                "left") \
+    X(KC_DOWN,                "down") \
+    X(KC_UP,                  "up") \
+    X(KC_NUMLOCK,             "numlock") \
+    X(KC_KP_SLASH,            "kp_slash") \
+    X(KC_KP_ASTERISK,         "kp_aster") \
+    X(KC_KP_MINUS,            "kp_minus") \
+    X(KC_KP_PLUS,             "kp_plus") \
+    X(KC_KP_ENTER,            "kp_enter") \
+    X(KC_KP_1,                "kp_1") \
+    X(KC_KP_2,                "kp_2") \
+    X(KC_KP_3,                "kp_3") \
+    X(KC_KP_4,                "kp_4") \
+    X(KC_KP_5,                "kp_5") \
+    X(KC_KP_6,                "kp_6") \
+    X(KC_KP_7,                "kp_7") \
+    X(KC_KP_8,                "kp_8") \
+    X(KC_KP_9,                "kp_9") \
+    X(KC_KP_0,                "kp_0") \
+    X(KC_KP_DOT,              "kp_dot") \
+    X(KC_NONUS_BSLASH,        "nus_bslsh") \
+    X(KC_APPLICATION,         "appl") \
+    X(KC_POWER,               "power") \
+    X(KC_KP_EQUAL,            "kp_equal") \
+    X(KC_F13,                 "f13") \
+    X(KC_F14,                 "f14") \
+    X(KC_F15,                 "f15") \
+    X(KC_F16,                 "f16") \
+    X(KC_F17,                 "f17") \
+    X(KC_F18,                 "f18") \
+    X(KC_F19,                 "f19") \
+    X(KC_F20,                 "f20") \
+    X(KC_F21,                 "f21") \
+    X(KC_F22,                 "f22") \
+    X(KC_F23,                 "f23") \
+    X(KC_F24,                 "f24") \
+    X(KC_EXECUTE,             "execute") \
+    X(KC_HELP,                "help") \
+    X(KC_MENU,                "menu") \
+    X(KC_SELECT,              "select") \
+    X(KC_STOP,                "stop") \
+    X(KC_AGAIN,               "again") \
+    X(KC_UNDO,                "undo") \
+    X(KC_CUT,                 "cut") \
+    X(KC_COPY,                "copy") \
+    X(KC_PASTE,               "paste") \
+    X(KC_FIND,                "find") \
+    X(KC__MUTE,               "mute") \
+    X(KC__VOLUP,              "volup") \
+    X(KC__VOLDOWN,            "voldown") \
+    X(KC_LOCKING_CAPS,        "lck_caps") \
+    X(KC_LOCKING_NUM,         "lck_num") \
+    X(KC_LOCKING_SCROLL,      "lck_scrll") \
+    X(KC_KP_COMMA,            "kp_comma") \
+    X(KC_KP_EQUAL_AS400,      "kp_eq_as4") \
+    X(KC_INT1,                "int1") \
+    X(KC_INT2,                "int2") \
+    X(KC_INT3,                "int3") \
+    X(KC_INT4,                "int4") \
+    X(KC_INT5,                "int5") \
+    X(KC_INT6,                "int6") \
+    X(KC_INT7,                "int7") \
+    X(KC_INT8,                "int8") \
+    X(KC_INT9,                "int9") \
+    X(KC_LANG1,               "lang1") \
+    X(KC_LANG2,               "lang2") \
+    X(KC_LANG3,               "lang3") \
+    X(KC_LANG4,               "lang4") \
+    X(KC_LANG5,               "lang5") \
+    X(KC_LANG6,               "lang6") \
+    X(KC_LANG7,               "lang7") \
+    X(KC_LANG8,               "lang8") \
+    X(KC_LANG9,               "lang9") \
+    X(KC_ALT_ERASE,           "alt_erase") \
+    X(KC_SYSREQ,              "sysreq") \
+    X(KC_CANCEL,              "cancel") \
+    X(KC_CLEAR,               "clear") \
+    X(KC_PRIOR,               "prior") \
+    X(KC_RETURN,              "return") \
+    X(KC_SEPARATOR,           "separator") \
+    X(KC_OUT,                 "out") \
+    X(KC_OPER,                "oper") \
+    X(KC_CLEAR_AGAIN,         "clr_again") \
+    X(KC_CRSEL,               "crsel") \
+    X(KC_EXSEL,               "exsel") \
+    X(KC_KP_00,               "kp_00") \
+    X(KC_KP_000,              "kp_000") \
+    X(KC_THOUSANDS_SEPARATOR, "1000s_sep") \
+    X(KC_DECIMAL_SEPARATOR,   "dec_sep") \
+    X(KC_CURRENCY_UNIT,       "cur_unit") \
+    X(KC_CURRENCY_SUB_UNIT,   "c_subunit") \
+    X(KC_KP_LPAREN,           "kp_lparen") \
+    X(KC_KP_RPAREN,           "kp_rparen") \
+    X(KC_KP_LCBRACKET,        "kp_lcbrck") \
+    X(KC_KP_RCBRACKET,        "kp_rcbrck") \
+    X(KC_KP_TAB,              "kp_tab") \
+    X(KC_KP_BSPACE,           "kp_bspace") \
+    X(KC_KP_A,                "kp_a") \
+    X(KC_KP_B,                "kp_b") \
+    X(KC_KP_C,                "kp_c") \
+    X(KC_KP_D,                "kp_d") \
+    X(KC_KP_E,                "kp_e") \
+    X(KC_KP_F,                "kp_f") \
+    X(KC_KP_XOR,              "kp_xor") \
+    X(KC_KP_HAT,              "kp_hat") \
+    X(KC_KP_PERC,             "kp_perc") \
+    X(KC_KP_LT,               "kp_lt") \
+    X(KC_KP_GT,               "kp_gt") \
+    X(KC_KP_AND,              "kp_and") \
+    X(KC_KP_LAZYAND,          "kp_lzyand") \
+    X(KC_KP_OR,               "kp_or") \
+    X(KC_KP_LAZYOR,           "kp_lazyor") \
+    X(KC_KP_COLON,            "kp_colon") \
+    X(KC_KP_HASH,             "kp_hash") \
+    X(KC_KP_SPACE,            "kp_space") \
+    X(KC_KP_ATMARK,           "kp_atmark") \
+    X(KC_KP_EXCLAMATION,      "kp_exclam") \
+    X(KC_KP_MEM_STORE,        "kp_m_sto") \
+    X(KC_KP_MEM_RECALL,       "kp_m_rcl") \
+    X(KC_KP_MEM_CLEAR,        "kp_m_clr") \
+    X(KC_KP_MEM_ADD,          "kp_m_add") \
+    X(KC_KP_MEM_SUB,          "kp_m_sub") \
+    X(KC_KP_MEM_MUL,          "kp_m_mul") \
+    X(KC_KP_MEM_DIV,          "kp_m_div") \
+    X(KC_KP_PLUS_MINUS,       "kp_plu_mi") \
+    X(KC_KP_CLEAR,            "kp_clr") \
+    X(KC_KP_CLEAR_ENTRY,      "kp_clr_en") \
+    X(KC_KP_BINARY,           "kp_binary") \
+    X(KC_KP_OCTAL,            "kp_octal") \
+    X(KC_KP_DECIMAL,          "kp_dec") \
+    X(KC_KP_HEXADECIMAL,      "kp_hex") \
+    X(KC_LCTRL,               "lctrl") \
+    X(KC_LSHIFT,              "lshift") \
+    X(KC_LALT,                "lalt") \
+    X(KC_LGUI,                "lgui") \
+    X(KC_RCTRL,               "rctrl") \
+    X(KC_RSHIFT,              "rshift") \
+    X(KC_RALT,                "ralt") \
+    X(KC_RGUI,                "rgui") \
+    X(KC_FN0,                 "macro_0") \
+    X(KC_FN1,                 "macro_1") \
+    X(KC_FN2,                 "macro_2") \
+    X(KC_FN3,                 "macro_3") \
+    X(KC_FN4,                 "macro_4") \
+    X(KC_FN5,                 "macro_5") \
+    X(KC_FN6,                 "macro_6") \
+    X(KC_FN7,                 "macro_7")
+
+static const struct code_names {
+    char none[1];
+    CODE_NAMES(NAME_MEMBER)
+} code_names PROGMEM = {"", CODE_NAMES(NAME_STRING)};
+
+#define CODE_NAME_OFFSET(id, name) [id] = offsetof(struct code_names, id),
+static const uint16_t code_name_offset[] PROGMEM = {
+    CODE_NAMES(CODE_NAME_OFFSET)
 };
 
-static const char chrdfunc_name[][CODE_NAME_LEN + 1] PROGMEM = {
-    [SWAP_CHRDS] = "swap chds",
-    [MCR_RECORD] = "rec macro",
-    [PRINT]      = "prnt chds",
-    [RESET]      = "reset kbd",
+#define CHRDFUNC_NAMES(X) \
+    X(SWAP_CHRDS, "swap chds") \
+    X(MCR_RECORD, "rec macro") \
+    X(PRINT,      "prnt chds") \
+    X(RESET,      "reset kbd") \
+    X(TRACE_DUMP, "dump trce") \
+    X(RTT_TEST,   "echo rtt") \
+    X(NEXT_PROFILE, "next prof")
+
+static const struct chrdfunc_names {
+    char none[1];
+    CHRDFUNC_NAMES(NAME_MEMBER)
+} chrdfunc_names PROGMEM = {"", CHRDFUNC_NAMES(NAME_STRING)};
+
+#define CHRDFUNC_NAME_OFFSET(id, name) [id] = offsetof(struct chrdfunc_names, id),
+static const uint16_t chrdfunc_name_offset[] PROGMEM = {
+    CHRDFUNC_NAMES(CHRDFUNC_NAME_OFFSET)
 };
 
-static const char layer_name[][CODE_NAME_LEN + 1] PROGMEM = {
-    [L_NUM] = "numpad lr",
-    [L_NAV] = "nav lr",
-    [L_MSE] = "mouse lr",
-    [L_MCR] = "macro lr",
+#define LAYER_NAMES(X) \
+    X(L_NUM, "numpad lr") \
+    X(L_NAV, "nav lr") \
+    X(L_MSE, "mouse lr") \
+    X(L_MCR, "macro lr")
+
+static const struct layer_names {
+    char none[1];
+    LAYER_NAMES(NAME_MEMBER)
+} layer_names PROGMEM = {"", LAYER_NAMES(NAME_STRING)};
+
+#define LAYER_NAME_OFFSET(id, name) [id] = offsetof(struct layer_names, id),
+static const uint16_t layer_name_offset[] PROGMEM = {
+    LAYER_NAMES(LAYER_NAME_OFFSET)
 };
 
+/*
+ * Name i from pool, or "" if there is none
+ */
+static const char *
+name_P(const void *pool, const uint16_t *offset, uint8_t len, uint8_t i)
+{
+    return (const char *)pool + (i < len ? pgm_read_word(offset + i) : 0);
+}
+
     
+/*************************************************************
+ * Sub-millisecond timing
+ *************************************************************/
+/* Timer1 runs freely at F_CPU/64, i.e. 4us per tick, wrapping after
+   262ms.  Its compare units are free for interrupts. */
+#define UTIMER_PRESCALE 64
+#if HYBRID_WINDOW_US >= 250000
+#error "HYBRID_WINDOW_US exceeds the Timer1 period"
+#endif
+#define US_TO_UTICKS(us) ((uint16_t)((us) * (F_CPU / 1000000) / UTIMER_PRESCALE))
+#define UTICKS_TO_US(t) ((t) * (UTIMER_PRESCALE / (F_CPU / 1000000)))
+
+static void
+utimer_init(void)
+{
+    TCCR1A = 0;
+    TCCR1B = 1<<CS11 | 1<<CS10;
+}
+
+static uint16_t
+utimer_read(void)
+{
+    uint16_t t;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        t = TCNT1;
+    }
+    return t;
+}
+
+static uint16_t
+utimer_elapsed(uint16_t last)
+{
+    return utimer_read() - last;
+}
+
+/* saturating */
+static uint16_t
+uticks_to_us(uint16_t ticks)
+{
+    return ticks < US_TO_UTICKS(UINT16_MAX) ? UTICKS_TO_US(ticks) : UINT16_MAX;
+}
+
+
+/*************************************************************
+ * Scheduling of time-based work
+ *************************************************************/
+/*
+ * Tasks run from hook_keyboard_loop(), i.e. right after each matrix
+ * scan, when due.  A task returns the utimer ticks until it wants to
+ * run again, or SCHED_IDLE to sleep until sched_wake().  The earliest
+ * deadline goes into OCR1B, so a loop pass with nothing due costs one
+ * flag test.  Lower task ids go first; once SCHED_BUDGET is used up,
+ * the rest waits for the next pass.
+ */
+enum task {
+    TASK_CHRD, TASK_LEDS, TASK_EEPROM, TASK_PRINT,
+#if RTT_ROUNDS
+    TASK_RTT,
+#endif
+    TASKS
+};
+#define SCHED_IDLE 0
+#define SCHED_ASAP 1
+#define SCHED_HORIZON US_TO_UTICKS(100000UL) /* well within Timer1 period */
+#define SCHED_BUDGET US_TO_UTICKS(1000)
+#define MS_TO_UTICKS(ms) ((uint16_t)((ms) * US_TO_UTICKS(1000)))
+
+static struct {
+    uint16_t due;
+    bool armed;
+} tasks[TASKS];
+
+/* some task is due without OCR1B knowing */
+static bool sched_pending = false;
+
+static void
+sched_wake(uint8_t task)
+{
+    tasks[task].due = utimer_read();
+    tasks[task].armed = true;
+    sched_pending = true;
+}
+
+
+#if TRACE_LEN
+/*************************************************************
+ * Event trace
+ *************************************************************/
+/*
+ * The last TRACE_LEN events with their utimer time, to be dumped by
+ * the TRACE_DUMP chord and read by trace-decoder/trace.go.  While
+ * nothing happens, hook_keyboard_loop() counts half utimer periods in
+ * a TR_IDLE record so that long gaps can be told apart from short
+ * ones.
+ */
+#if TRACE_LEN & (TRACE_LEN - 1) || TRACE_LEN > 128
+#error "TRACE_LEN must be a power of 2 no larger than 128"
+#endif
+/* keep in sync with trace-decoder/trace.go */
+enum trace_ev {
+    TR_NONE,
+    TR_IDLE,                    /* arg: half utimer periods */
+    TR_KEY,                     /* arg: pressed<<7 | row<<4 | col */
+    TR_COMMIT,                  /* arg: finger chord */
+    TR_EMIT,                    /* arg: keycode from emit_chrd() */
+    TR_REPORT,                  /* arg: keycode sent */
+    TR_EEPROM,                  /* arg: low byte of address written */
+    TR_LED,                     /* arg: on<<7 | led */
+};
+
+static struct {
+    uint16_t t;
+    uint8_t ev;
+    uint8_t arg;
+} trace_buf[TRACE_LEN];
+static uint8_t trace_head = 0;  /* next to be written */
+static uint16_t trace_last;
+static bool trace_frozen = false; /* while dumping */
+
+static void
+trace(uint8_t ev, uint8_t arg)
+{
+    uint8_t i = trace_head;
+
+    if (trace_frozen)
+        return;
+    trace_last = trace_buf[i].t = utimer_read();
+    trace_buf[i].ev = ev;
+    trace_buf[i].arg = arg;
+    trace_head = (i + 1) & (TRACE_LEN - 1);
+}
+
+static void
+trace_idle(void)
+{
+    uint8_t newest = (trace_head - 1) & (TRACE_LEN - 1);
+
+    if (utimer_elapsed(trace_last) < 0x8000 || trace_frozen)
+        return;
+    if (trace_buf[newest].ev == TR_IDLE && trace_buf[newest].arg < UINT8_MAX) {
+        trace_buf[newest].arg++;
+        trace_last += 0x8000;
+    } else {
+        trace(TR_IDLE, 1);
+    }
+}
+#else
+#define trace(ev, arg)
+#endif
+
+
 /*************************************************************
  * Illumination
  *************************************************************/
 
 enum led_cmd {OFF = 0, ON = 1, STATE};
 #define FOREVER UINT8_MAX
-#define LED_ON(port, bit) {(PORT##port) |= (1<<(bit));} while (0)
-#define LED_OFF(port, bit) {(PORT##port) &= ~(1<<(bit));} while (0)
-#define LED_STATE(port, bit) ((PORT##port) & (1<<(bit)))
-#define LED_INIT(port, bit) {(DDR##port) |= (1<<(bit));} while (0)
+
+/* LEDs currently lit, per port (leds.h) */
+static uint8_t lit[LED_PORTS];
+
+/*
+ * Brightness is modulated by bit angle modulation from the Timer1
+ * compare A interrupt: the four bits of a LED's level are shown for 1,
+ * 2, 4, and 8 PWM_UNITs, respectively.  That's four interrupts per
+ * 1.9ms cycle, each costing three port writes and a compare register
+ * update.
+ */
+#define PWM_BITS 4
+#define PWM_UNIT 32             /* utimer ticks; 128us */
+
+/* per PWM bit, per port: LEDs whose level has that bit set */
+static volatile uint8_t pwm_planes[PWM_BITS][LED_PORTS];
+
+ISR(TIMER1_COMPA_vect)
+{
+    static uint8_t bit = 0;
+
+    led_ports_write(pwm_planes[bit]);
+    OCR1A += PWM_UNIT<<bit;
+    bit = (bit + 1) % PWM_BITS;
+}
+
+/* LED brightness over the on time of a blink pattern */
+/* These are parsed by the cheatsheet generator. */
+#define FADE_STEPS 16
+enum fade {FADE_NONE, FADE_DIM, FADE_OUT, FADE_BREATHE,};
+#define FADE_VARIES(FADE) ((FADE) >= FADE_OUT)
+
+static const uint8_t fade_curves[][FADE_STEPS] PROGMEM = {
+    [FADE_NONE]    = {15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15},
+    [FADE_DIM]     = {3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3},
+    [FADE_OUT]     = {15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0},
+    [FADE_BREATHE] = {1, 2, 4, 6, 9, 12, 14, 15, 15, 14, 12, 9, 6, 4, 2, 1},
+};
+
+static struct {
+    uint8_t on;
+    uint8_t off;
+    uint16_t last;
+    uint8_t cycles;
+    uint8_t fade;
+} leds[12] = {{0}};
+
+#if CHRDMAP_PROFILES > 1
+/* LEDs showing the active chordmap profile whenever they are idle */
+static uint16_t profile_leds = 0;
+#define BLINK_PROFILE 250, 0, FOREVER, FADE_DIM
+
+static void
+led_pattern(uint8_t i, uint8_t on, uint8_t off, uint8_t cycles, uint8_t fade)
+{
+    leds[i].on = on;
+    leds[i].off = off;
+    leds[i].cycles = cycles;
+    leds[i].fade = fade;
+}
+#endif
 
 /*
  * Set or return state of an LED
@@ -864,103 +958,115 @@ enum led_cmd {OFF = 0, ON = 1, STATE};
 static bool
 led(uint8_t led, uint8_t cmd)
 {
+    uint8_t port = pgm_read_byte(&led_pins[led].port);
+    uint8_t mask = pgm_read_byte(&led_pins[led].mask);
+    uint8_t b;
+
     switch (cmd) {
     case ON:
-        switch (led) {
-        case 0: LED_ON(D, 0); break;
-        case 1: LED_ON(D, 4); break;
-        case 2: LED_ON(D, 5); break;
-        case 3: LED_ON(D, 6); break;
-        case 4: LED_ON(B, 0); break;
-        case 5: LED_ON(B, 1); break;
-        case 6: LED_ON(B, 4); break;
-        case 7: LED_ON(B, 5); break;
-        case 8: LED_ON(B, 6); break;
-        case 9: LED_ON(B, 7); break;
-        case 10: LED_ON(C, 5); break;
-        case 11: LED_ON(C, 6); break;
+        lit[port] |= mask;
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            for (b = 0; b < PWM_BITS; b++)
+                pwm_planes[b][port] |= mask;
         }
         break;
     case OFF:
-        switch (led) {
-        case 0: LED_OFF(D, 0); break;
-        case 1: LED_OFF(D, 4); break;
-        case 2: LED_OFF(D, 5); break;
-        case 3: LED_OFF(D, 6); break;
-        case 4: LED_OFF(B, 0); break;
-        case 5: LED_OFF(B, 1); break;
-        case 6: LED_OFF(B, 4); break;
-        case 7: LED_OFF(B, 5); break;
-        case 8: LED_OFF(B, 6); break;
-        case 9: LED_OFF(B, 7); break;
-        case 10: LED_OFF(C, 5); break;
-        case 11: LED_OFF(C, 6); break;
+        lit[port] &= ~mask;
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            for (b = 0; b < PWM_BITS; b++)
+                pwm_planes[b][port] &= ~mask;
         }
         break;
     case STATE:
-        switch (led) {
-        case 0: return LED_STATE(D, 0); break;
-        case 1: return LED_STATE(D, 4); break;
-        case 2: return LED_STATE(D, 5); break;
-        case 3: return LED_STATE(D, 6); break;
-        case 4: return LED_STATE(B, 0); break;
-        case 5: return LED_STATE(B, 1); break;
-        case 6: return LED_STATE(B, 4); break;
-        case 7: return LED_STATE(B, 5); break;
-        case 8: return LED_STATE(B, 6); break;
-        case 9: return LED_STATE(B, 7); break;
-        case 10: return LED_STATE(C, 5); break;
-        case 11: return LED_STATE(C, 6); break;
-        }
+        return lit[port] & mask;
         break;
     }
+    trace(TR_LED, cmd<<7 | led);
+    sched_wake(TASK_LEDS);
     return false;
 }
 
 static void
 led_init(void)
 {
-    LED_INIT(D, 0);
-    LED_INIT(D, 4);
-    LED_INIT(D, 5);
-    LED_INIT(D, 6);
-    LED_INIT(B, 0);
-    LED_INIT(B, 1);
-    LED_INIT(B, 4);
-    LED_INIT(B, 5);
-    LED_INIT(B, 6);
-    LED_INIT(B, 7);
-    LED_INIT(C, 5);
-    LED_INIT(C, 6);
+    led_ports_init();
+    OCR1A = utimer_read() + PWM_UNIT;
+    TIFR1 = 1<<OCF1A;
+    TIMSK1 |= 1<<OCIE1A;
 }
 
-static struct {
-    uint8_t on;
-    uint8_t off;
-    uint16_t last;
-    uint8_t cycles;
-} leds[12] = {{0}};
-
-static void
+/*
+ * Apply due LED transitions; return ms until the next one, 0 if none
+ * is pending
+ */
+static uint16_t
 update_leds(void)
 {
-    int8_t i;
+    uint8_t i, b, port, mask, level, planes[PWM_BITS][LED_PORTS] = {{0}};
+    uint16_t now = timer_read(), elapsed, wait, next = 0;
 
     for (i = 0; i < 12; i++) {
-        if (led(i, STATE)) {
-            if (timer_elapsed(leds[i].last) > leds[i].on) {
-                led(i, OFF);
-                leds[i].last = timer_read();
+        port = pgm_read_byte(&led_pins[i].port);
+        mask = pgm_read_byte(&led_pins[i].mask);
+        elapsed = now - leds[i].last;
+        if (lit[port] & mask) {
+            if (elapsed > leds[i].on) {
+                lit[port] &= ~mask;
+                trace(TR_LED, OFF<<7 | i);
+                leds[i].last = now;
+                elapsed = 0;
             }
         } else {
-            if (timer_elapsed(leds[i].last) > leds[i].off && leds[i].cycles > 0) {
-                led(i, ON);
-                leds[i].last = timer_read();
+            if (elapsed > leds[i].off && leds[i].cycles > 0) {
+                lit[port] |= mask;
+                trace(TR_LED, ON<<7 | i);
+                leds[i].last = now;
+                elapsed = 0;
                 if (leds[i].cycles != FOREVER)
                     leds[i].cycles--;
             }
         }
+#if CHRDMAP_PROFILES > 1
+        if (!leds[i].cycles && !(lit[port] & mask) && profile_leds & 1<<i) {
+            led_pattern(i, BLINK_PROFILE);
+            leds[i].last = now;
+            elapsed = 0;
+        }
+#endif
+        if (lit[port] & mask) {
+            level = pgm_read_byte(&fade_curves[leds[i].fade][elapsed * FADE_STEPS
+                                                             / (leds[i].on + 1)]);
+            for (b = 0; b < PWM_BITS; b++)
+                if (level & 1<<b)
+                    planes[b][port] |= mask;
+            wait = leds[i].on + 1 - elapsed;
+            if (FADE_VARIES(leds[i].fade) && wait > leds[i].on / FADE_STEPS + 1)
+                wait = leds[i].on / FADE_STEPS + 1; /* next fade step */
+        } else if (leds[i].cycles > 0) {
+            wait = leds[i].off + 1 - elapsed;
+        } else {
+            continue;
+        }
+        if (!next || wait < next)
+            next = wait;
     }
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        for (b = 0; b < PWM_BITS; b++)
+            for (port = 0; port < LED_PORTS; port++)
+                pwm_planes[b][port] = planes[b][port];
+    }
+    return next;
+}
+
+static uint16_t
+leds_task(void)
+{
+    uint16_t wait;
+
+    bench_start(BENCH_LEDS);
+    wait = update_leds();
+    bench_end(BENCH_LEDS);
+    return wait ? MS_TO_UTICKS(wait) : SCHED_IDLE;
 }
 
 /* Subsets of the LEDs */
@@ -980,62 +1086,70 @@ enum ledset_id {
     LEDS_RECORD_MCR,
     LEDS_PRINT,
     LEDS_RESET,
+    LEDS_PROFILE_ONE,
+    LEDS_PROFILE_TWO,
+    LEDS_PROFILE_THREE,
 };
 
 static const struct {
     uint8_t len;
     uint8_t leds[12];
 } ledsets[] PROGMEM = {
-    [LEDS_ALL_MODS]    = {.len = 7,  .leds = {2, 3, 4, 5, 9, 10, 11}},
-    [LEDS_ALT]         = {.len = 2,  .leds = {3, 10}},
-    [LEDS_CHG_LAYER]   = {.len = 12, .leds = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11}},
-    [LEDS_CTL]         = {.len = 2,  .leds = {4, 9}},
-    [LEDS_GUI]         = {.len = 2,  .leds = {2, 11}},
-    [LEDS_NO_KEYCODE]  = {.len = 3,  .leds = {0, 1, 8}},
-    [LEDS_NUM_LOCK]    = {.len = 1,  .leds = {6}},
-    [LEDS_PRINT]       = {.len = 12, .leds = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11}},
-    [LEDS_RECORD_MCR]  = {.len = 3,  .leds = {0, 1, 8}},
-    [LEDS_RESET]       = {.len = 12, .leds = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11}},
-    [LEDS_SCROLL_LOCK] = {.len = 1,  .leds = {7}},
-    [LEDS_SFT]         = {.len = 1,  .leds = {5}},
-    [LEDS_SWAP_FIRST]  = {.len = 2,  .leds = {4, 9}},
-    [LEDS_SWAP_SECOND] = {.len = 2,  .leds = {2, 11}},
+    [LEDS_ALL_MODS]      = {.len = 7,  .leds = {2, 3, 4, 5, 9, 10, 11}},
+    [LEDS_ALT]           = {.len = 2,  .leds = {3, 10}},
+    [LEDS_CHG_LAYER]     = {.len = 12, .leds = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11}},
+    [LEDS_CTL]           = {.len = 2,  .leds = {4, 9}},
+    [LEDS_GUI]           = {.len = 2,  .leds = {2, 11}},
+    [LEDS_NO_KEYCODE]    = {.len = 3,  .leds = {0, 1, 8}},
+    [LEDS_NUM_LOCK]      = {.len = 1,  .leds = {6}},
+    [LEDS_PRINT]         = {.len = 12, .leds = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11}},
+    [LEDS_PROFILE_ONE]   = {.len = 1,  .leds = {0}},
+    [LEDS_PROFILE_TWO]   = {.len = 2,  .leds = {0, 1}},
+    [LEDS_PROFILE_THREE] = {.len = 3,  .leds = {0, 1, 8}},
+    [LEDS_RECORD_MCR]    = {.len = 3,  .leds = {0, 1, 8}},
+    [LEDS_RESET]         = {.len = 12, .leds = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11}},
+    [LEDS_SCROLL_LOCK]   = {.len = 1,  .leds = {7}},
+    [LEDS_SFT]           = {.len = 1,  .leds = {5}},
+    [LEDS_SWAP_FIRST]    = {.len = 2,  .leds = {4, 9}},
+    [LEDS_SWAP_SECOND]   = {.len = 2,  .leds = {2, 11}},
     /* not used here; for documentation:
        [LEDS_INIT]     = {.len = 1,  .leds = {8}},
     */
 };
 
-/* blink patterns: on time, off time, cycles (0-255) */
+/* blink patterns: on time, off time, cycles (0-255), fade curve */
 /* These are parsed by the cheatsheet generator. */
-#define BLINK_CHG_LAYER 250, 0, 1
-#define BLINK_ERROR 10, 40, 10
-#define BLINK_MCR_WARNING 10, 40, FOREVER
-#define BLINK_OK 200, 0, 2
-#define BLINK_ONESHOT_MODS 200, 20, FOREVER
-#define BLINK_RESET 10, 0, 1
-#define BLINK_REVERSE_ONESHOT_MODS 20, 200, FOREVER
-#define BLINK_STEADY 250, 0, FOREVER
-#define BLINK_STOP 0, 0, 0
-#define BLINK_TOGGLED_MODS 250, 0, FOREVER
-#define BLINK_WAITING 50, 50, FOREVER
-#define BLINK_WARNING 10, 40, 3
+#define BLINK_BUSY 250, 0, FOREVER, FADE_BREATHE
+#define BLINK_CHG_LAYER 250, 0, 1, FADE_OUT
+#define BLINK_ERROR 10, 40, 10, FADE_NONE
+#define BLINK_LOCK 250, 0, FOREVER, FADE_DIM
+#define BLINK_MCR_WARNING 10, 40, FOREVER, FADE_NONE
+#define BLINK_OK 200, 0, 2, FADE_NONE
+#define BLINK_ONESHOT_MODS 200, 20, FOREVER, FADE_NONE
+#define BLINK_RESET 10, 0, 1, FADE_NONE
+#define BLINK_REVERSE_ONESHOT_MODS 20, 200, FOREVER, FADE_NONE
+#define BLINK_STEADY 250, 0, FOREVER, FADE_NONE
+#define BLINK_STOP 0, 0, 0, FADE_NONE
+#define BLINK_TOGGLED_MODS 250, 0, FOREVER, FADE_DIM
+#define BLINK_WAITING 50, 50, FOREVER, FADE_NONE
+#define BLINK_WARNING 10, 40, 3, FADE_NONE
 
 /* LED signalling: LED set, blink pattern  */
 /* The trailing comments are extracted by the cheatsheet generator. */
 #define CHG_LAYER_ON LEDS_CHG_LAYER, BLINK_CHG_LAYER /* Switching layer */
 #define NO_KEYCODE_ON LEDS_NO_KEYCODE, BLINK_WARNING /* Unmapped chord */
-#define NUM_LOCK_ON LEDS_NUM_LOCK, BLINK_STEADY      /* Num Lock */
+#define NUM_LOCK_ON LEDS_NUM_LOCK, BLINK_LOCK        /* Num Lock */
 #define ONESHOT_ALT_ON LEDS_ALT, BLINK_ONESHOT_MODS  /* Mod: ALT, sticky */
 #define ONESHOT_CTL_ON LEDS_CTL, BLINK_ONESHOT_MODS  /* Mod: CTRL, sticky */
 #define ONESHOT_GUI_ON LEDS_GUI, BLINK_ONESHOT_MODS  /* Mod: GUI, sticky */
 #define ONESHOT_SFT_ON LEDS_SFT, BLINK_ONESHOT_MODS  /* Mod: SHIFT, sticky */
 #define ONESHOT_SFT_REVERSE_ON LEDS_SFT, BLINK_REVERSE_ONESHOT_MODS /* Mod: unSHIFT */
-#define PRINT_ON LEDS_PRINT, BLINK_STEADY /* Typing chordmap */
+#define PRINT_ON LEDS_PRINT, BLINK_BUSY /* Typing chordmap */
 #define RECORD_MCR_OK_ON LEDS_RECORD_MCR, BLINK_OK /* Macro: done */
 #define RECORD_MCR_ON LEDS_RECORD_MCR, BLINK_WAITING /* Macro: recording */
 #define RECORD_MCR_WARNING_ON LEDS_RECORD_MCR, BLINK_WARNING /* Macro: too long */
 #define RESET_ON LEDS_RESET, BLINK_RESET                     /* Keyboard reset */
-#define SCROLL_LOCK_ON LEDS_SCROLL_LOCK, BLINK_STEADY        /* Scroll Lock */
+#define SCROLL_LOCK_ON LEDS_SCROLL_LOCK, BLINK_LOCK          /* Scroll Lock */
 #define SWAP_FIRST_ON LEDS_SWAP_FIRST, BLINK_WAITING         /* Swap: chord A? */
 #define SWAP_SECOND_ERROR_ON LEDS_SWAP_SECOND, BLINK_ERROR   /* Swap: rejected */
 #define SWAP_SECOND_OK_ON LEDS_SWAP_SECOND, BLINK_OK         /* Swap: done */
@@ -1048,86 +1162,609 @@ static const struct {
 /* not used here; for documentation: */
 #define INIT_KBD_ON LEDS_INIT, BLINK_STEADY /* Keyboard start up */
 
+/* mod and lock LEDs may have been overwritten since last blink_mods() */
+static bool mods_leds_stale = true;
+
 static void
-blink(uint8_t id, uint8_t on, uint8_t off, uint8_t cycles)
+blink(uint8_t id, uint8_t on, uint8_t off, uint8_t cycles, uint8_t fade)
 {
     uint8_t i, len;
 
+    switch (id) {
+    case LEDS_SFT:
+    case LEDS_CTL:
+    case LEDS_ALT:
+    case LEDS_GUI:
+    case LEDS_NUM_LOCK:
+    case LEDS_SCROLL_LOCK:
+        break;
+    default:
+        mods_leds_stale = true;
+        break;
+    }
+
     len = pgm_read_byte(ledsets + id);
     for (i = 0; i < len; i++) {
         uint8_t led_num;
 
         led_num = pgm_read_byte((uint8_t *)(ledsets + id) + 1 + i);
-        leds[led_num].on = on;
+        /* Stopping cuts endless patterns short but lets the last
+           flash of a finite one finish.  A signal like RESET_ON would
+           otherwise be cut by the blink_mods() redraw right after it,
+           which only the blocking wait in RESET used to hold off. */
+        if (cycles || leds[led_num].cycles)
+            leds[led_num].on = on;
         leds[led_num].off = off;
         leds[led_num].cycles = cycles;
+        leds[led_num].fade = fade;
     }
+    sched_wake(TASK_LEDS);
 }
 
+/*
+ * Show mods and host LEDs, touching only the LEDs whose state changed
+ */
 static void
 blink_mods(void)
 {
-    uint8_t m, wm;
+    static uint8_t prev_m, prev_wm, prev_hkbl;
+    uint8_t m, wm, m_chg, hkbl_chg;
     uint8_t hkbl = host_keyboard_leds();
     uint8_t alt = MOD_LALT, sft = MOD_LSFT, gui = MOD_LGUI, ctl = MOD_LCTL;
     uint8_t cpslck = hkbl & 1<<USB_LED_CAPS_LOCK;
 
-    keyboard_set_leds(hkbl);
     m = get_mods();
     wm = get_weak_mods() & ~m;
     m = m>>4 | (m & 0xf);
     wm = wm>>4 | (wm & 0xf);
-    if (m & alt)
-        blink(TOGGLED_ALT_ON);
-    else
-        blink(OFF(ALT));
-    if (wm & alt)
-        blink(ONESHOT_ALT_ON);
-    if (m & gui)
-        blink(TOGGLED_GUI_ON);
-    else
-        blink(OFF(GUI));
-    if (wm & gui)
-        blink(ONESHOT_GUI_ON);
-    if (m & ctl)
-        blink(TOGGLED_CTL_ON);
-    else
-        blink(OFF(CTL));
-    if (wm & ctl)
-        blink(ONESHOT_CTL_ON);
-    if (((m & sft) && cpslck) || (!(m & sft) && !cpslck)) {
-        if (wm & sft)
-            blink(ONESHOT_SFT_ON);
+    if (mods_leds_stale) {
+        m_chg = hkbl_chg = 0xff;
+        mods_leds_stale = false;
+    } else {
+        m_chg = (m ^ prev_m) | (wm ^ prev_wm);
+        hkbl_chg = hkbl ^ prev_hkbl;
+    }
+    prev_m = m;
+    prev_wm = wm;
+    prev_hkbl = hkbl;
+    if (hkbl_chg)
+        keyboard_set_leds(hkbl);
+    if (m_chg & alt) {
+        if (m & alt)
+            blink(TOGGLED_ALT_ON);
         else
-            blink(OFF(SFT));
-    } else if ((m & sft) && !cpslck) {
-        blink(TOGGLED_SFT_ON);
-    } else if (!(m & sft) && cpslck) {
-        if (wm & sft)
-            blink(ONESHOT_SFT_REVERSE_ON);
+            blink(OFF(ALT));
+        if (wm & alt)
+            blink(ONESHOT_ALT_ON);
+    }
+    if (m_chg & gui) {
+        if (m & gui)
+            blink(TOGGLED_GUI_ON);
+        else
+            blink(OFF(GUI));
+        if (wm & gui)
+            blink(ONESHOT_GUI_ON);
+    }
+    if (m_chg & ctl) {
+        if (m & ctl)
+            blink(TOGGLED_CTL_ON);
         else
+            blink(OFF(CTL));
+        if (wm & ctl)
+            blink(ONESHOT_CTL_ON);
+    }
+    if ((m_chg & sft) || (hkbl_chg & 1<<USB_LED_CAPS_LOCK)) {
+        if (((m & sft) && cpslck) || (!(m & sft) && !cpslck)) {
+            if (wm & sft)
+                blink(ONESHOT_SFT_ON);
+            else
+                blink(OFF(SFT));
+        } else if ((m & sft) && !cpslck) {
             blink(TOGGLED_SFT_ON);
+        } else if (!(m & sft) && cpslck) {
+            if (wm & sft)
+                blink(ONESHOT_SFT_REVERSE_ON);
+            else
+                blink(TOGGLED_SFT_ON);
+        }
+    }
+    if (hkbl_chg & 1<<USB_LED_NUM_LOCK) {
+        if (hkbl & (1<<USB_LED_NUM_LOCK))
+            blink(NUM_LOCK_ON);
+        else
+            blink(OFF(NUM_LOCK));
+    }
+    if (hkbl_chg & 1<<USB_LED_SCROLL_LOCK) {
+        if (hkbl & (1<<USB_LED_SCROLL_LOCK))
+            blink(SCROLL_LOCK_ON);
+        else
+            blink(OFF(SCROLL_LOCK));
     }
-    if (hkbl & (1<<USB_LED_NUM_LOCK))
-        blink(NUM_LOCK_ON);
-    else
-        blink(OFF(NUM_LOCK));
-    if (hkbl & (1<<USB_LED_SCROLL_LOCK))
-        blink(SCROLL_LOCK_ON);
-    else
-        blink(OFF(SCROLL_LOCK));
 }
 
 
 /*************************************************************
- * Printing
+ * Statistics
+ *************************************************************/
+#define STAT_NAME_LEN 16
+
+enum stat {
+    STAT_MAX_LOOP_US,
+#if CORRECT_CHRDS
+    STAT_CORRECTED,
+#endif
+#if CHRDMAP_PROFILES > 1
+    STAT_PROFILE,
+#endif
+#if FAST_BOOT
+    STAT_BOOT_USB_MS,
+    STAT_BOOT_KEYS,
+    STAT_BOOT_LOST,
+#endif
+#if RTT_ROUNDS
+    STAT_RTT_ECHOES,
+    STAT_RTT_MIN_US,
+    STAT_RTT_AVG_US,
+    STAT_RTT_MAX_US,
+#endif
+    STATS
+};
+
+static const char stat_name[][STAT_NAME_LEN + 1] PROGMEM = {
+    [STAT_MAX_LOOP_US] = "max loop us",
+#if CORRECT_CHRDS
+    [STAT_CORRECTED] = "corrected chords",
+#endif
+#if CHRDMAP_PROFILES > 1
+    [STAT_PROFILE] = "chordmap profile",
+#endif
+#if FAST_BOOT
+    [STAT_BOOT_USB_MS] = "usb ready ms",
+    [STAT_BOOT_KEYS] = "keys before usb",
+    [STAT_BOOT_LOST] = "boot keys lost",
+#endif
+#if RTT_ROUNDS
+    [STAT_RTT_ECHOES] = "rtt echoes",
+    [STAT_RTT_MIN_US] = "rtt min us",
+    [STAT_RTT_AVG_US] = "rtt avg us",
+    [STAT_RTT_MAX_US] = "rtt max us",
+#endif
+};
+
+static uint16_t stats[STATS];
+
+#if CORRECT_CHRDS || FAST_BOOT
+static void
+count(uint8_t stat)
+{
+    if (stats[stat] < UINT16_MAX)
+        stats[stat]++;
+}
+#endif
+
+static void
+stat_max(uint8_t stat, uint16_t value)
+{
+    if (value > stats[stat])
+        stats[stat] = value;
+}
+
+
+#if USAGE_COUNTS
+/*************************************************************
+ * Chord usage
+ *************************************************************/
+/*
+ * One 4-bit counter per chordmap, fn_chordmap, and thumb chord entry.
+ * A counter at n is incremented with probability 2^-n, so it stands
+ * for roughly 2^n - 1 uses and saturates after some 30000.  There is
+ * no room left in EEPROM to keep them across resets.
+ */
+enum usage {
+    USAGE_FNG = 0,
+    USAGE_FN = USAGE_FNG + 256,
+    USAGE_THB = USAGE_FN + 128,
+    USAGE_LEN = USAGE_THB + 8,
+};
+#define USAGE_NONE UINT16_MAX
+
+static uint8_t usage[USAGE_LEN / 2];
+
+static uint8_t
+usage_get(uint16_t i)
+{
+    return usage[i / 2] >> (i & 1) * 4 & 0xf;
+}
+
+static void
+usage_count(uint16_t i)
+{
+    static uint16_t rnd = 1;
+    uint8_t n = usage_get(i);
+
+    /* xorshift, stirred by the time of use */
+    rnd ^= utimer_read();
+    rnd ^= rnd << 7;
+    rnd ^= rnd >> 9;
+    rnd ^= rnd << 8;
+    if (n < 0xf && !(rnd & ((1U<<n) - 1)))
+        usage[i / 2] += 1 << (i & 1) * 4;
+}
+#endif
+
+
+#if TYPING_STATS
+/*************************************************************
+ * Typing timing
+ *************************************************************/
+/*
+ * Histograms of, per committed chord, the time between its first and
+ * its last key press (spread), between its first key press and its
+ * commit (hold), and between the previous commit and its first key
+ * press (gap).  Plus keycodes typed over the last minute.
+ */
+enum tm_hist {TM_SPREAD, TM_HOLD, TM_GAP, TM_HISTS};
+#define TM_BINS 8               /* < 8ms<<bin; the last takes the rest */
+#define WPM_SLOTS 6
+#define WPM_SLOT_MS 10000UL
+
+static struct {
+    uint16_t first;             /* key press */
+    uint16_t last;              /* key press */
+    uint16_t commit;
+    uint16_t hist[TM_HISTS][TM_BINS];
+    uint32_t slot_start;
+    uint8_t slot;
+    uint8_t typed[WPM_SLOTS];
+} tm;
+
+static void
+tm_add(uint8_t hist, uint16_t ms)
+{
+    uint8_t i;
+
+    for (i = 0; i < TM_BINS - 1 && ms >= 8U<<i; i++);
+    if (tm.hist[hist][i] < UINT16_MAX)
+        tm.hist[hist][i]++;
+}
+
+static void
+tm_press(bool first)
+{
+    tm.last = timer_read();
+    if (first)
+        tm.first = tm.last;
+}
+
+static void
+tm_commit(void)
+{
+    uint16_t now = timer_read();
+
+    tm_add(TM_SPREAD, tm.last - tm.first);
+    tm_add(TM_HOLD, now - tm.first);
+    tm_add(TM_GAP, tm.first - tm.commit);
+    tm.commit = now;
+}
+
+/*
+ * Move the one-minute window up to now
+ */
+static void
+wpm_slide(void)
+{
+    uint32_t elapsed = timer_read32() - tm.slot_start;
+    uint8_t i;
+
+    if (elapsed >= WPM_SLOTS * WPM_SLOT_MS) {
+        for (i = 0; i < WPM_SLOTS; i++)
+            tm.typed[i] = 0;
+        tm.slot_start = timer_read32();
+        return;
+    }
+    for (; elapsed >= WPM_SLOT_MS; elapsed -= WPM_SLOT_MS) {
+        tm.slot = (tm.slot + 1) % WPM_SLOTS;
+        tm.typed[tm.slot] = 0;
+        tm.slot_start += WPM_SLOT_MS;
+    }
+}
+
+static void
+wpm_count(void)
+{
+    wpm_slide();
+    if (tm.typed[tm.slot] < UINT8_MAX)
+        tm.typed[tm.slot]++;
+}
+
+/*
+ * Words of five keycodes per minute
+ */
+static uint16_t
+wpm(void)
+{
+    uint16_t typed = 0;
+    uint8_t i;
+
+    wpm_slide();
+    for (i = 0; i < WPM_SLOTS; i++)
+        typed += tm.typed[i];
+    return typed / 5;
+}
+#endif
+
+
+#if PROFILE
+/*************************************************************
+ * Loop profile
+ *************************************************************/
+/*
+ * Utimer ticks spent per section of the main loop.  Single timings
+ * are quantized to 4us, which averages out over many loop passes.
+ * Sums and counts are halved before running out of range, so older
+ * passes weigh less.  Frozen while printing, which leaves nothing to
+ * show for the printing task itself.
+ */
+enum prof_section {
+    PROF_LOOP,                  /* whole loop period */
+    PROF_SCAN,
+    PROF_ACTION,                /* TMK's, incl. chord collection */
+    PROF_TASK,
+    PROF_SECTIONS = PROF_TASK + TASKS,
+};
+#define PROF_HIST_BINS 8        /* loop periods < 16us<<bin; last: rest */
+#define PROF_SUM_MAX (1UL<<24)
+
+static const char prof_name[][STAT_NAME_LEN + 1] PROGMEM = {
+    [PROF_LOOP]               = "loop",
+    [PROF_SCAN]               = "matrix scan",
+    [PROF_ACTION]             = "actions",
+    [PROF_TASK + TASK_CHRD]   = "chord timers",
+    [PROF_TASK + TASK_LEDS]   = "leds",
+    [PROF_TASK + TASK_EEPROM] = "eeprom",
+#if RTT_ROUNDS
+    [PROF_TASK + TASK_RTT]    = "rtt timeout",
+#endif
+};
+
+extern uint16_t matrix_scan_start, matrix_scan_end;
+
+static struct {
+    uint32_t sum;
+    uint16_t n;
+    uint16_t max;
+} prof[PROF_SECTIONS];
+static uint16_t prof_hist[PROF_HIST_BINS];
+static bool prof_frozen = false;
+
+static void
+prof_add(uint8_t section, uint16_t ticks)
+{
+    uint8_t i;
+
+    if (prof_frozen)
+        return;
+    prof[section].sum += ticks;
+    prof[section].n++;
+    if (ticks > prof[section].max)
+        prof[section].max = ticks;
+    if (section != PROF_LOOP)
+        return;
+    for (i = 0; i < PROF_HIST_BINS - 1 && ticks >= US_TO_UTICKS(16)<<i; i++);
+    prof_hist[i]++;
+    /* the loop has the largest sum and count */
+    if (prof[PROF_LOOP].n == UINT16_MAX || prof[PROF_LOOP].sum >= PROF_SUM_MAX) {
+        for (i = 0; i < PROF_SECTIONS; i++) {
+            prof[i].sum >>= 1;
+            prof[i].n >>= 1;
+        }
+        for (i = 0; i < PROF_HIST_BINS; i++)
+            prof_hist[i] >>= 1;
+    }
+}
+#endif
+
+
+/*************************************************************
+ * EEPROM write-behind
+ *************************************************************/
+/*
+ * Writing an EEPROM byte takes 3.4ms.  Writes are queued and done by
+ * TASK_EEPROM one byte at a time; reads see queued bytes.  A write to
+ * a full queue waits for the oldest queued byte to be written.
+ */
+#define EE_QUEUE_LEN 16
+#define EE_WRITE_TICKS US_TO_UTICKS(3400)
+
+static struct {
+    uint8_t *addr;
+    uint8_t val;
+} ee_queue[EE_QUEUE_LEN];
+static uint8_t ee_queued = 0;
+
+static void
+ee_read_block(void *dst, const void *src, size_t n)
+{
+    uint8_t i;
+
+    eeprom_read_block(dst, src, n);
+    for (i = 0; i < ee_queued; i++)
+        if (ee_queue[i].addr >= (uint8_t *)src &&
+            ee_queue[i].addr < (uint8_t *)src + n)
+            ((uint8_t *)dst)[ee_queue[i].addr - (uint8_t *)src] = ee_queue[i].val;
+}
+
+static uint16_t
+ee_read_word(const uint16_t *src)
+{
+    uint16_t w;
+
+    ee_read_block(&w, src, sizeof(uint16_t));
+    return w;
+}
+
+/*
+ * Write oldest queued byte
+ */
+static void
+ee_write_next(void)
+{
+    uint8_t i;
+
+    bench_start(BENCH_EEPROM);
+    eeprom_write_byte(ee_queue[0].addr, ee_queue[0].val);
+    trace(TR_EEPROM, (uintptr_t)ee_queue[0].addr);
+    ee_queued--;
+    for (i = 0; i < ee_queued; i++)
+        ee_queue[i] = ee_queue[i + 1];
+    bench_end(BENCH_EEPROM);
+}
+
+static void
+ee_update_byte(uint8_t *addr, uint8_t val)
+{
+    uint8_t i;
+
+    for (i = 0; i < ee_queued; i++)
+        if (ee_queue[i].addr == addr) {
+            ee_queue[i].val = val;
+            return;
+        }
+    if (eeprom_read_byte(addr) == val)
+        return;
+    if (ee_queued == EE_QUEUE_LEN) {
+        dlog(CHRD, DLOG_INFO, "eeprom queue full\n");
+        ee_write_next();
+    }
+    ee_queue[ee_queued].addr = addr;
+    ee_queue[ee_queued].val = val;
+    ee_queued++;
+    sched_wake(TASK_EEPROM);
+}
+
+static void
+ee_update_block(const void *src, void *dst, size_t n)
+{
+    size_t i;
+
+    for (i = 0; i < n; i++)
+        ee_update_byte((uint8_t *)dst + i, ((uint8_t *)src)[i]);
+}
+
+static void
+ee_update_word(uint16_t *dst, uint16_t w)
+{
+    ee_update_block(&w, dst, sizeof(uint16_t));
+}
+
+static uint16_t
+eeprom_task(void)
+{
+    if (!ee_queued)
+        return SCHED_IDLE;
+    if (!eeprom_is_ready())
+        return EE_WRITE_TICKS / 4;
+    ee_write_next();
+    return ee_queued ? EE_WRITE_TICKS : SCHED_IDLE;
+}
+
+
+/*************************************************************
+ * Chordmap profiles
  *************************************************************/
+#if CHRDMAP_PROFILES > 1
+static uint8_t profile = 0;
 
+static void
+next_profile(void)
+{
+    uint8_t id, i;
+
+    profile = (profile + 1) % CHRDMAP_PROFILES;
+    stats[STAT_PROFILE] = profile;
+    /* The profile LED sets are nested, so flashing the new one covers
+       the old one; back at profile 0 (none), flash the last one. */
+    id = LEDS_PROFILE_ONE + (profile ? profile : CHRDMAP_PROFILES - 1) - 1;
+    profile_leds = 0;
+    if (profile)
+        for (i = 0; i < pgm_read_byte(&ledsets[id].len); i++)
+            profile_leds |= (uint16_t)1<<pgm_read_byte(&ledsets[id].leds[i]);
+    blink(id, BLINK_OK);
+}
+#endif
+
+/*
+ * Keypair of finger chord chrd in the active profile
+ */
+static void
+read_keypair(uint8_t chrd, keypair_t *kp)
+{
+#if CHRDMAP_PROFILES > 1
+    if (profile) {
+        memcpy_P(kp, &chrdmap_profile[profile - 1][chrd], sizeof(keypair_t));
+        return;
+    }
+#endif
+    ee_read_block(kp, chrdmap + chrd, sizeof(keypair_t));
+}
+
+
+/*************************************************************
+ * Working memory of modal subsystems
+ *************************************************************/
+/*
+ * Printing, macro recording, and the fast boot queue never need their
+ * buffers at the same time.  Whoever claims the arena first has it
+ * until releasing it; other claims fail meanwhile.
+ */
 #define LINEBUFLEN 50
+
+enum arena_user {ARENA_FREE, ARENA_PRINT, ARENA_MCR, ARENA_BOOT,};
+
+static union {
+    struct {
+        char linebuf[LINEBUFLEN];
+        char modsbuf[LINEBUFLEN];
+    } print;
+    struct {
+        uint8_t k[MCR_LEN];
+        uint8_t m[MCR_LEN];
+    } mcr;
+#if FAST_BOOT
+    struct {
+        uint8_t event[FAST_BOOT]; /* pressed<<7 | row<<4 | col */
+    } boot;
+#endif
+} arena;
+
+static uint8_t arena_user = ARENA_FREE;
+
+static bool
+arena_claim(uint8_t user)
+{
+    if (arena_user != ARENA_FREE && arena_user != user)
+        return false;
+    arena_user = user;
+    return true;
+}
+
+static void
+arena_release(uint8_t user)
+{
+    if (arena_user == user)
+        arena_user = ARENA_FREE;
+}
+
+
+/*************************************************************
+ * Printing
+ *************************************************************/
+
 #define HDRHEIGHT 3
 
-enum header {KEYPAIR_HDR, FN_ACT_HDR, THB_ACT_HDR,};
-enum print {PRINT_CANCEL, PRINT_START, PRINT_NEXT,};
+enum header {KEYPAIR_HDR, ORD_HDR, FN_ACT_HDR, THB_ACT_HDR, USAGE_HDR, TM_HDR,
+             STATS_HDR, PROF_HDR, TRACE_HDR,};
+enum print {PRINT_CANCEL, PRINT_START, PRINT_NEXT, PRINT_TRACE, PRINT_STATS,};
 
 static uint8_t
 strtocodes (char *buf)
@@ -1161,6 +1798,11 @@ static const char print_header[][HDRHEIGHT][LINEBUFLEN] PROGMEM = {
                      "       -----lower-----      -----upper-----\n",
                      "  rows mod code c name      mod code c name\n"
                      "\n",},
+    [ORD_HDR]     = {"\n"
+                     "  ******** ordered finger chords ********\n\n",
+                     " *first key 0-left 3-right\n",
+                     " *rows mod code c name      mod code c name\n"
+                     "\n",},
     [FN_ACT_HDR]  = {"\n"
                      "  ******* fn finger chords *******\n\n",
                      "  *fn    modifiers *oneshot-toggle\n",
@@ -1168,9 +1810,33 @@ static const char print_header[][HDRHEIGHT][LINEBUFLEN] PROGMEM = {
                      "\n",},
     [THB_ACT_HDR] = {"\n"
                      "  ****** bottom row chords ******\n\n",
-                     "       modifiers *fn-upper-lower\n",
+                     "       modifiers *fn-upper-lower-hold\n",
                      "  rows left rght * code name\n"
                      "\n",},
+    [USAGE_HDR]   = {"\n"
+                     "  ****** chord usage ******\n\n",
+                     "  digit n per entry: about 2 to the n uses\n",
+                     "  map  entry\n"
+                     "\n",},
+    [TM_HDR]      = {"\n"
+                     "  ****** typing timing ******\n\n",
+                     "  below  chords by\n",
+                     "     ms spread  hold   gap\n"
+                     "\n",},
+    [STATS_HDR]   = {"\n"
+                     "  ****** statistics ******\n\n",
+                     "  count what\n",
+                     "\n",},
+    [PROF_HDR]    = {"\n"
+                     "  ****** loop profile ******\n\n",
+                     "  share   avg   max in us\n",
+                     "    pct    us    us what\n"
+                     "\n",},
+    [TRACE_HDR]   = {"\n"
+                     "  ****** trace ******\n\n",
+                     "  ticks of 4us\n",
+                     "  tick ev arg\n"
+                     "\n",},
 };
 
 static void
@@ -1180,17 +1846,20 @@ fmt_hdr(uint8_t hdr_kind, uint8_t hdr_line, char *linebuf, uint8_t *len)
     *len = strtocodes(linebuf);
 }
 
+/*
+ * first is the column to be pressed first, or ' ' for any
+ */
 static void
-fmt_keypair(uint8_t chrd, char *linebuf, char *modsbuf, uint8_t *len)
+fmt_kp(uint8_t chrd, keypair_t kp, char first,
+       char *linebuf, char *modsbuf, uint8_t *len)
 {
     char name_lo[CODE_NAME_LEN + 1] = "", name_up[CODE_NAME_LEN + 1] = "";
-    keypair_t kp;
 
-    eeprom_read_block(&kp, chrdmap + chrd, sizeof(keypair_t));
-    strcpy_P(name_lo, (char *)(code_name + kp.code_lo));
-    strcpy_P(name_up, (char *)(code_name + kp.code_up));
+    strcpy_P(name_lo, NAME_P(code_name, kp.code_lo));
+    strcpy_P(name_up, NAME_P(code_name, kp.code_up));
     snprintf(linebuf, LINEBUFLEN,
-             "* %x%x%x%x %c%c%c%c%#04x   %-9s %c%c%c%c%#04x   %-s\n",
+             "*%c%x%x%x%x %c%c%c%c%#04x   %-9s %c%c%c%c%#04x   %-s\n",
+             first,
              (chrd & 3<<6)>>6,
              (chrd & 3<<4)>>4,
              (chrd & 3<<2)>>2,
@@ -1222,6 +1891,26 @@ fmt_keypair(uint8_t chrd, char *linebuf, char *modsbuf, uint8_t *len)
     }
 }
 
+static void
+fmt_keypair(uint8_t chrd, char *linebuf, char *modsbuf, uint8_t *len)
+{
+    keypair_t kp;
+
+    read_keypair(chrd, &kp);
+    fmt_kp(chrd, kp, ' ', linebuf, modsbuf, len);
+}
+
+#if ORD_CHRDS
+static void
+fmt_ord_keypair(uint8_t i, char *linebuf, char *modsbuf, uint8_t *len)
+{
+    ord_chrd_t o;
+
+    memcpy_P(&o, ord_chrdmap + i, sizeof(ord_chrd_t));
+    fmt_kp(o.chrd, o.keypair, '0' + o.first, linebuf, modsbuf, len);
+}
+#endif
+
 static bool
 fmt_fn_action(uint8_t chrd, char *linebuf, uint8_t *len)
 {
@@ -1229,7 +1918,7 @@ fmt_fn_action(uint8_t chrd, char *linebuf, uint8_t *len)
     uint8_t mods = 0, row, keycode = 0;
     action_t a;
 
-    a.code = eeprom_read_word((uint16_t *)fn_chrdmap + chrd);
+    a.code = ee_read_word((uint16_t *)fn_chrdmap + chrd);
     if ((chrd >= 0x1 && chrd <= 0x10) || chrd == 0x20 || chrd == 0x30 ||
         (chrd >= 0x41 && chrd <= 0x50) || chrd == 0x60 || chrd == 0x70)
         /* unreachable chords */
@@ -1252,16 +1941,16 @@ fmt_fn_action(uint8_t chrd, char *linebuf, uint8_t *len)
         uint8_t func_id = a.func.opt, layer_id = a.func.id;
 
         if (func_id == CHG_LAYER)
-            strcpy_P(name, (char *)(layer_name + layer_id));
+            strcpy_P(name, NAME_P(layer_name, layer_id));
         else
-            strcpy_P(name, (char *)(chrdfunc_name + func_id));
+            strcpy_P(name, NAME_P(chrdfunc_name, func_id));
         break;
     }
     default:             /* plain finger chord from fn_chrdmap */
         keycode = a.key.code;
         mods = a.key.mods;
         mods_strength = '-';
-        strcpy_P(name, (char *)(code_name + keycode));
+        strcpy_P(name, NAME_P(code_name, keycode));
         break;
     }
     row = (chrd & 3<<4)>>4;
@@ -1303,11 +1992,16 @@ fmt_thb_action(uint8_t chrd, char *linebuf, uint8_t *len)
         keycode = a.key.code;
         mods = a.key.mods;
         level = '-';
-        strcpy_P(name, (char *)(code_name + keycode));
+        strcpy_P(name, NAME_P(code_name, keycode));
     } else if (a.kind.id == ACT_FUNCTION) {
-        uint8_t func_id = a.func.opt;
+        uint8_t func_id = a.func.opt, layer_id = a.func.id;
 
-        strcpy_P(name, (char *)(chrdfunc_name + func_id));
+        if (func_id == LAYER_MOMENTARY) {
+            level = 'h';
+            strcpy_P(name, NAME_P(layer_name, layer_id));
+        } else {
+            strcpy_P(name, NAME_P(chrdfunc_name, func_id));
+        }
     } else {
         level = a.kind.param ? '0' : '1';
     }
@@ -1330,26 +2024,187 @@ fmt_thb_action(uint8_t chrd, char *linebuf, uint8_t *len)
 }
 
 static void
+fmt_stat(uint8_t stat, char *linebuf, uint8_t *len)
+{
+    char name[STAT_NAME_LEN + 1];
+
+    strcpy_P(name, stat_name[stat]);
+    snprintf(linebuf, LINEBUFLEN, "  %5u %s\n", stats[stat], name);
+    *len = strtocodes(linebuf);
+}
+
+#if USAGE_COUNTS
+/*
+ * Format usage counters of 16 entries starting at 16 * n
+ */
+static void
+fmt_usage(uint8_t n, char *linebuf, uint8_t *len)
+{
+    uint16_t first = 16 * n, i, end;
+    uint8_t pos;
+
+    if (first < USAGE_FN)
+        pos = snprintf(linebuf, LINEBUFLEN, "  fng  %02x  ", first - USAGE_FNG);
+    else if (first < USAGE_THB)
+        pos = snprintf(linebuf, LINEBUFLEN, "  fn   %02x  ", first - USAGE_FN);
+    else
+        pos = snprintf(linebuf, LINEBUFLEN, "  thb  %02x  ", first - USAGE_THB);
+    end = first + 16 < USAGE_LEN ? first + 16 : USAGE_LEN;
+    for (i = first; i < end; i++) {
+        uint8_t u = usage_get(i);
+
+        linebuf[pos++] = u < 10 ? '0' + u : 'a' + u - 10;
+        if (i % 4 == 3)
+            linebuf[pos++] = ' ';
+    }
+    linebuf[pos++] = '\n';
+    linebuf[pos] = '\0';
+    *len = strtocodes(linebuf);
+}
+#endif
+
+#if TYPING_STATS
+/*
+ * Format bin n of the typing timing histograms, followed by the
+ * current typing speed
+ */
+static void
+fmt_tm(uint8_t n, char *linebuf, uint8_t *len)
+{
+    if (n < TM_BINS - 1)
+        snprintf(linebuf, LINEBUFLEN, "  %5u %6u %5u %5u\n", 8U<<n,
+                 tm.hist[TM_SPREAD][n], tm.hist[TM_HOLD][n], tm.hist[TM_GAP][n]);
+    else if (n < TM_BINS)
+        snprintf(linebuf, LINEBUFLEN, "   more %6u %5u %5u\n",
+                 tm.hist[TM_SPREAD][n], tm.hist[TM_HOLD][n], tm.hist[TM_GAP][n]);
+    else
+        snprintf(linebuf, LINEBUFLEN, "\n  %5u wpm\n", wpm());
+    *len = strtocodes(linebuf);
+}
+#endif
+
+#if PROFILE
+/*
+ * Format section n of the profile, followed by the loop period
+ * histogram
+ */
+static void
+fmt_prof(uint8_t n, char *linebuf, uint8_t *len)
+{
+    char name[STAT_NAME_LEN + 1];
+
+    if (n < PROF_SECTIONS) {
+        uint32_t sum = prof[n].sum, total = prof[PROF_LOOP].sum;
+        uint16_t cnt = prof[n].n ? prof[n].n : 1;
+        uint16_t avg_us = uticks_to_us(sum / cnt) + UTICKS_TO_US(sum % cnt) / cnt;
+
+        strcpy_P(name, prof_name[n]);
+        snprintf(linebuf, LINEBUFLEN, "  %5u %5u %5u %s\n",
+                 (uint16_t)(total ? sum * 100 / total : 0),
+                 avg_us,
+                 uticks_to_us(prof[n].max),
+                 name);
+    } else if ((n -= PROF_SECTIONS) < PROF_HIST_BINS - 1) {
+        snprintf(linebuf, LINEBUFLEN, "  %5u loops under %u us\n",
+                 prof_hist[n], 16<<n);
+    } else {
+        snprintf(linebuf, LINEBUFLEN, "  %5u loops longer\n", prof_hist[n]);
+    }
+    *len = strtocodes(linebuf);
+}
+#endif
+
+#if TRACE_LEN
+/*
+ * Format the nth oldest trace record; false if unused
+ */
+static bool
+fmt_trace(uint8_t n, char *linebuf, uint8_t *len)
+{
+    uint8_t i = (trace_head + n) & (TRACE_LEN - 1);
+
+    if (trace_buf[i].ev == TR_NONE)
+        return false;
+    snprintf(linebuf, LINEBUFLEN, "  %04x %x %02x\n",
+             trace_buf[i].t, trace_buf[i].ev, trace_buf[i].arg);
+    *len = strtocodes(linebuf);
+    return true;
+}
+#endif
+
+/*
+ * Return true while printing
+ */
+static bool
 print_chrdmaps(uint8_t cmd)
 {
     enum {FMT_KEYPAIR_HDR, FMT_KEYPAIR, FMT_FN_ACT_HDR, FMT_FN_ACT,
-          FMT_THB_ACT_HDR, FMT_THB_ACT, PRINTING_LN, DONE, IDLE,};
+          FMT_ORD_HDR, FMT_ORD, FMT_THB_ACT_HDR, FMT_THB_ACT,
+          FMT_USAGE_HDR, FMT_USAGE, FMT_TM_HDR, FMT_TM,
+          FMT_STATS_HDR, FMT_STATS, FMT_PROF_HDR, FMT_PROF,
+          FMT_TRACE_HDR, FMT_TRACE,
+          PRINTING_LN, DONE, IDLE,};
     static uint8_t printing = IDLE, scheduled_printing = IDLE;
     static uint16_t fng_chrd = 0;
     static uint8_t fn_chrd, thb_chrd = 0;
-    static uint8_t fng_hdr = 0,fn_hdr = 0, thb_hdr = 0;
-    static char linebuf[LINEBUFLEN] = "", modsbuf[LINEBUFLEN] = "";
+    static uint8_t fng_hdr = 0,fn_hdr = 0, thb_hdr = 0, stats_hdr = 0, stat = 0;
+    static bool stats_only = false;
+#if ORD_CHRDS
+    static uint8_t ord_hdr = 0, ord_chrd = 0;
+#endif
+#if USAGE_COUNTS
+    static uint8_t usage_hdr = 0, usage_line = 0;
+#endif
+#if TYPING_STATS
+    static uint8_t tm_hdr = 0, tm_line = 0;
+#endif
+#if PROFILE
+    static uint8_t prof_hdr = 0, prof_line = 0;
+#endif
+#if TRACE_LEN
+    static uint8_t trace_hdr = 0, trace_rec = 0;
+#endif
+    char * const linebuf = arena.print.linebuf;
+    char * const modsbuf = arena.print.modsbuf;
     static uint8_t i, buflen, bufpos = 0;
 
     switch (cmd) {
     case PRINT_START:
-        fng_hdr = fn_hdr = thb_hdr = 0;
+    case PRINT_TRACE:
+    case PRINT_STATS:
+        if (!arena_claim(ARENA_PRINT)) {
+            blink(RECORD_MCR_WARNING_ON);
+            break;
+        }
+        for (i = 0; i < LINEBUFLEN; modsbuf[i++] = 0);
+        fng_hdr = fn_hdr = thb_hdr = stats_hdr = 0;
+        stat = 0;
+        stats_only = cmd == PRINT_STATS;
+#if ORD_CHRDS
+        ord_hdr = ord_chrd = 0;
+#endif
+#if USAGE_COUNTS
+        usage_hdr = usage_line = 0;
+#endif
+#if TYPING_STATS
+        tm_hdr = tm_line = 0;
+#endif
+#if PROFILE
+        prof_hdr = prof_line = 0;
+        prof_frozen = true;
+#endif
+#if TRACE_LEN
+        trace_hdr = trace_rec = 0;
+        trace_frozen = cmd == PRINT_TRACE;
+#endif
         fng_chrd = 0;
         fn_chrd = 0;
         thb_chrd = 0;
         bufpos = 0;
         clear_keyboard();
-        printing = FMT_KEYPAIR_HDR;
+        printing = cmd == PRINT_TRACE ? FMT_TRACE_HDR :
+            stats_only ? FMT_STATS_HDR : FMT_KEYPAIR_HDR;
+        sched_wake(TASK_PRINT);
         break;
     case PRINT_CANCEL:
         printing = DONE;
@@ -1386,10 +2241,32 @@ print_chrdmaps(uint8_t cmd)
                 fng_chrd++;
                 printing = PRINTING_LN;
                 scheduled_printing = FMT_KEYPAIR;
+            } else {
+                printing = ORD_CHRDS ? FMT_ORD_HDR : FMT_FN_ACT_HDR;
+            }
+            break;
+#if ORD_CHRDS
+        case FMT_ORD_HDR:
+            if (ord_hdr < HDRHEIGHT) {
+                fmt_hdr(ORD_HDR, ord_hdr, linebuf, &buflen);
+                ord_hdr++;
+                printing = PRINTING_LN;
+                scheduled_printing = FMT_ORD_HDR;
+            } else {
+                printing = FMT_ORD;
+            }
+            break;
+        case FMT_ORD:
+            if (ord_chrd < ORD_CHRDMAP_LEN) {
+                fmt_ord_keypair(ord_chrd, linebuf, modsbuf, &buflen);
+                ord_chrd++;
+                printing = PRINTING_LN;
+                scheduled_printing = FMT_ORD;
             } else {
                 printing = FMT_FN_ACT_HDR;
             }
             break;
+#endif
         case FMT_FN_ACT_HDR:
             if (fn_hdr < HDRHEIGHT) {
                 fmt_hdr(FN_ACT_HDR, fn_hdr, linebuf, &buflen);
@@ -1412,28 +2289,148 @@ print_chrdmaps(uint8_t cmd)
                 printing = FMT_THB_ACT_HDR;
             }
             break;
-        case FMT_THB_ACT_HDR:
-            if (thb_hdr < HDRHEIGHT) {
-                fmt_hdr(THB_ACT_HDR, thb_hdr, linebuf, &buflen);
-                thb_hdr++;
+        case FMT_THB_ACT_HDR:
+            if (thb_hdr < HDRHEIGHT) {
+                fmt_hdr(THB_ACT_HDR, thb_hdr, linebuf, &buflen);
+                thb_hdr++;
+                printing = PRINTING_LN;
+                scheduled_printing = FMT_THB_ACT_HDR;
+            } else {
+                printing = FMT_THB_ACT;
+            }
+            break;
+        case FMT_THB_ACT:
+            if (thb_chrd < 8) {
+                fmt_thb_action(thb_chrd, linebuf, &buflen);
+                thb_chrd++;
+                scheduled_printing = FMT_THB_ACT;
+                printing = PRINTING_LN;
+            } else {
+                printing = USAGE_COUNTS ? FMT_USAGE_HDR :
+                    TYPING_STATS ? FMT_TM_HDR : FMT_STATS_HDR;
+            }
+            break;
+#if USAGE_COUNTS
+        case FMT_USAGE_HDR:
+            if (usage_hdr < HDRHEIGHT) {
+                fmt_hdr(USAGE_HDR, usage_hdr, linebuf, &buflen);
+                usage_hdr++;
+                printing = PRINTING_LN;
+                scheduled_printing = FMT_USAGE_HDR;
+            } else {
+                printing = FMT_USAGE;
+            }
+            break;
+        case FMT_USAGE:
+            if (usage_line < (USAGE_LEN + 15) / 16) {
+                fmt_usage(usage_line, linebuf, &buflen);
+                usage_line++;
+                scheduled_printing = FMT_USAGE;
+                printing = PRINTING_LN;
+            } else {
+                printing = TYPING_STATS ? FMT_TM_HDR : FMT_STATS_HDR;
+            }
+            break;
+#endif
+#if TYPING_STATS
+        case FMT_TM_HDR:
+            if (tm_hdr < HDRHEIGHT) {
+                fmt_hdr(TM_HDR, tm_hdr, linebuf, &buflen);
+                tm_hdr++;
+                printing = PRINTING_LN;
+                scheduled_printing = FMT_TM_HDR;
+            } else {
+                printing = FMT_TM;
+            }
+            break;
+        case FMT_TM:
+            if (tm_line <= TM_BINS) {
+                fmt_tm(tm_line, linebuf, &buflen);
+                tm_line++;
+                scheduled_printing = FMT_TM;
+                printing = PRINTING_LN;
+            } else {
+                printing = FMT_STATS_HDR;
+            }
+            break;
+#endif
+        case FMT_STATS_HDR:
+            if (stats_hdr < HDRHEIGHT) {
+                fmt_hdr(STATS_HDR, stats_hdr, linebuf, &buflen);
+                stats_hdr++;
+                printing = PRINTING_LN;
+                scheduled_printing = FMT_STATS_HDR;
+            } else {
+                printing = FMT_STATS;
+            }
+            break;
+        case FMT_STATS:
+            if (stat < STATS) {
+                fmt_stat(stat, linebuf, &buflen);
+                stat++;
+                scheduled_printing = FMT_STATS;
+                printing = PRINTING_LN;
+            } else {
+                printing = PROFILE && !stats_only ? FMT_PROF_HDR : DONE;
+            }
+            break;
+#if PROFILE
+        case FMT_PROF_HDR:
+            if (prof_hdr < HDRHEIGHT) {
+                fmt_hdr(PROF_HDR, prof_hdr, linebuf, &buflen);
+                prof_hdr++;
+                printing = PRINTING_LN;
+                scheduled_printing = FMT_PROF_HDR;
+            } else {
+                printing = FMT_PROF;
+            }
+            break;
+        case FMT_PROF:
+            if (prof_line == PROF_TASK + TASK_PRINT)
+                prof_line++;
+            if (prof_line < PROF_SECTIONS + PROF_HIST_BINS) {
+                fmt_prof(prof_line, linebuf, &buflen);
+                prof_line++;
+                scheduled_printing = FMT_PROF;
                 printing = PRINTING_LN;
-                scheduled_printing = FMT_THB_ACT_HDR;
             } else {
-                printing = FMT_THB_ACT;
+                printing = DONE;
             }
             break;
-        case FMT_THB_ACT:
-            if (thb_chrd < 8) {
-                fmt_thb_action(thb_chrd, linebuf, &buflen);
-                thb_chrd++;
-                scheduled_printing = FMT_THB_ACT;
+#endif
+#if TRACE_LEN
+        case FMT_TRACE_HDR:
+            if (trace_hdr < HDRHEIGHT) {
+                fmt_hdr(TRACE_HDR, trace_hdr, linebuf, &buflen);
+                trace_hdr++;
                 printing = PRINTING_LN;
+                scheduled_printing = FMT_TRACE_HDR;
+            } else {
+                printing = FMT_TRACE;
+            }
+            break;
+        case FMT_TRACE:
+            if (trace_rec < TRACE_LEN) {
+                if (fmt_trace(trace_rec, linebuf, &buflen))
+                    printing = PRINTING_LN;
+                else
+                    printing = FMT_TRACE;
+                trace_rec++;
+                scheduled_printing = FMT_TRACE;
             } else {
                 printing = DONE;
             }
             break;
+#endif
         case DONE:
+#if PROFILE
+            prof_frozen = false;
+#endif
+#if TRACE_LEN
+            trace_frozen = false;
+#endif
             blink(OFF(PRINT));
+            arena_release(ARENA_PRINT);
             printing = IDLE;
             break;
         case IDLE:
@@ -1441,7 +2438,113 @@ print_chrdmaps(uint8_t cmd)
         }
         break;
     }
+    return printing != IDLE;
+}
+
+static uint16_t
+print_task(void)
+{
+    return print_chrdmaps(PRINT_NEXT) ? SCHED_ASAP : SCHED_IDLE;
+}
+
+
+#if RTT_ROUNDS
+/*************************************************************
+ * Round-trip latency
+ *************************************************************/
+/*
+ * Tap Caps Lock and time from sending the press report to the host's
+ * LED report coming back through hook_keyboard_leds_change(); tap
+ * again as soon as it has.  That covers both USB directions, the
+ * host's input stack, and up to one loop pass.  An even number of
+ * rounds leaves Caps Lock as it was.
+ */
+#if RTT_ROUNDS % 2 || RTT_ROUNDS > 255
+#error "RTT_ROUNDS must be even and below 256"
+#endif
+#define RTT_TIMEOUT US_TO_UTICKS(100000UL)
+
+static struct {
+    uint32_t sum;
+    uint16_t sent;
+    uint16_t min, max;
+    uint8_t round, echoes;
+    uint8_t leds;
+} rtt;
+
+static void
+rtt_send(void)
+{
+    add_key(KC_CAPSLOCK);
+    send_keyboard_report();
+    rtt.sent = utimer_read();
+    del_key(KC_CAPSLOCK);
+    send_keyboard_report();
+    rtt.round++;
+    sched_wake(TASK_RTT);
+}
+
+static void
+rtt_start(void)
+{
+    if (rtt.round)
+        return;
+    rtt.sum = 0;
+    rtt.min = UINT16_MAX;
+    rtt.max = 0;
+    rtt.echoes = 0;
+    rtt.leds = host_keyboard_leds();
+    clear_keyboard();
+    rtt_send();
+}
+
+static void
+rtt_done(void)
+{
+    rtt.round = 0;
+    stats[STAT_RTT_ECHOES] = rtt.echoes;
+    stats[STAT_RTT_MIN_US] = rtt.echoes ? rtt.min : 0;
+    stats[STAT_RTT_AVG_US] = rtt.echoes ? rtt.sum / rtt.echoes : 0;
+    stats[STAT_RTT_MAX_US] = rtt.max;
+    print_chrdmaps(PRINT_STATS);
+}
+
+static void
+rtt_echo(uint8_t led_status)
+{
+    uint16_t us = uticks_to_us(utimer_elapsed(rtt.sent));
+
+    if (!rtt.round || !((led_status ^ rtt.leds) & 1<<USB_LED_CAPS_LOCK))
+        return;
+    rtt.leds = led_status;
+    rtt.echoes++;
+    rtt.sum += us;
+    if (us < rtt.min)
+        rtt.min = us;
+    if (us > rtt.max)
+        rtt.max = us;
+    if (rtt.round < RTT_ROUNDS)
+        rtt_send();
+    else
+        rtt_done();
+}
+
+/*
+ * Give up on an echo that doesn't come
+ */
+static uint16_t
+rtt_task(void)
+{
+    uint16_t elapsed = utimer_elapsed(rtt.sent);
+
+    if (!rtt.round)
+        return SCHED_IDLE;
+    if (elapsed < RTT_TIMEOUT)
+        return RTT_TIMEOUT - elapsed;
+    rtt_done();
+    return SCHED_IDLE;
 }
+#endif
 
 
 /*************************************************************
@@ -1483,8 +2586,16 @@ swap_chrds(void)
     {
         keypair_t kp1, kp2, kpa, kpb;
 
-        eeprom_read_block(&kp1, chrdmap + swap.chrd1, sizeof(keypair_t));
-        eeprom_read_block(&kp2, chrdmap + swap.chrd2, sizeof(keypair_t));
+#if CHRDMAP_PROFILES > 1
+        if (profile) {          /* flash profiles are read-only */
+            swap.state = IDLE;
+            blink(SWAP_SECOND_ERROR_ON);
+            break;
+        }
+#endif
+
+        ee_read_block(&kp1, chrdmap + swap.chrd1, sizeof(keypair_t));
+        ee_read_block(&kp2, chrdmap + swap.chrd2, sizeof(keypair_t));
         kpa = kp1;
         kpb = kp2;
         if (swap.level1 == swap.level2) {
@@ -1517,8 +2628,8 @@ swap_chrds(void)
             kpa = kp1;
             kpb = kp2;
         }
-        eeprom_update_block(&kpa, chrdmap + swap.chrd1, sizeof(keypair_t));
-        eeprom_update_block(&kpb, chrdmap + swap.chrd2, sizeof(keypair_t));
+        ee_update_block(&kpa, chrdmap + swap.chrd1, sizeof(keypair_t));
+        ee_update_block(&kpb, chrdmap + swap.chrd2, sizeof(keypair_t));
         swap.state = IDLE;
         blink(SWAP_SECOND_OK_ON);
         break;
@@ -1527,10 +2638,10 @@ swap_chrds(void)
     {
         action_t a1, a2;
 
-        a1.code = eeprom_read_word((uint16_t *)fn_chrdmap + swap.chrd1);
-        a2.code = eeprom_read_word((uint16_t *)fn_chrdmap + swap.chrd2);
-        eeprom_update_word((uint16_t *)fn_chrdmap + swap.chrd1, a2.code);
-        eeprom_update_word((uint16_t *)fn_chrdmap + swap.chrd2, a1.code);
+        a1.code = ee_read_word((uint16_t *)fn_chrdmap + swap.chrd1);
+        a2.code = ee_read_word((uint16_t *)fn_chrdmap + swap.chrd2);
+        ee_update_word((uint16_t *)fn_chrdmap + swap.chrd1, a2.code);
+        ee_update_word((uint16_t *)fn_chrdmap + swap.chrd2, a1.code);
         swap.state = IDLE;
         blink(SWAP_SECOND_OK_ON);
         break;
@@ -1552,7 +2663,7 @@ swap_chrds(void)
 static void
 emit_keycode(uint8_t weak_mods, uint8_t keycode, bool success_elsewhere);
 
-enum mcr_cmd {START_REC, COLLECT, EXEC, CANCEL_MCR,};
+enum mcr_cmd {START_REC, COLLECT, EXEC, CANCEL_MCR, IS_RECORDING,};
 enum mcr_chrd_direction {GET, PUT,};
 
 static void
@@ -1568,12 +2679,12 @@ mcr_chrd(uint8_t direction, uint8_t mcr, uint8_t c,
     modsn_word_idx = (mods0_word_idx * 4 +
                       mods0_nibble_idx + (mcr * MCR_LEN) + c) / 4;
     modsn_nibble_idx = (mods0_nibble_idx + (mcr * MCR_LEN) + c) % 4;
-    modsn_word = eeprom_read_word((uint16_t *)fn_chrdmap +
-                                  pgm_read_byte(fn_chrdmap_holes + modsn_word_idx));
+    modsn_word = ee_read_word((uint16_t *)fn_chrdmap +
+                               pgm_read_byte(fn_chrdmap_holes + modsn_word_idx));
     keyn_word_idx = (mcr * MCR_LEN + c) / 2;
     keyn_byte_idx = (mcr * MCR_LEN + c) % 2;
-    keyn_word = eeprom_read_word((uint16_t *)fn_chrdmap +
-                                 pgm_read_byte(fn_chrdmap_holes + keyn_word_idx));
+    keyn_word = ee_read_word((uint16_t *)fn_chrdmap +
+                              pgm_read_byte(fn_chrdmap_holes + keyn_word_idx));
     switch (direction) {
     case GET:
         modsn_nibble = modsn_word & (0x0f<<modsn_nibble_idx * 4);
@@ -1584,14 +2695,14 @@ mcr_chrd(uint8_t direction, uint8_t mcr, uint8_t c,
     case PUT:
         modsn_word &= ~(0x0f<<modsn_nibble_idx * 4);
         modsn_word |= *mods<<modsn_nibble_idx * 4;
-        eeprom_update_word((uint16_t *)fn_chrdmap +
-                           pgm_read_byte(fn_chrdmap_holes + modsn_word_idx),
-                           modsn_word);
+        ee_update_word((uint16_t *)fn_chrdmap +
+                        pgm_read_byte(fn_chrdmap_holes + modsn_word_idx),
+                        modsn_word);
         keyn_word &= ~(0xff<<keyn_byte_idx * 8);
         keyn_word |= *keycode<<keyn_byte_idx * 8;
-        eeprom_update_word((uint16_t *)fn_chrdmap +
-                           pgm_read_byte(fn_chrdmap_holes + keyn_word_idx),
-                           keyn_word);
+        ee_update_word((uint16_t *)fn_chrdmap +
+                        pgm_read_byte(fn_chrdmap_holes + keyn_word_idx),
+                        keyn_word);
         break;
     }
 }
@@ -1600,13 +2711,17 @@ static bool
 mcr(uint8_t cmd, uint8_t keycode)
 {
     static enum {RECORDING, IDLE,} state = IDLE;
-    static uint8_t k[MCR_LEN] = {0};
-    static uint8_t m[MCR_LEN] = {0};
     static uint8_t idx = 0;
+    uint8_t * const k = arena.mcr.k;
+    uint8_t * const m = arena.mcr.m;
     uint8_t i, fn_n = keycode - KC_FN0, mods = 0, kc;
 
     switch (cmd) {
     case START_REC:
+        if (!arena_claim(ARENA_MCR)) {
+            blink(RECORD_MCR_WARNING_ON);
+            return false;
+        }
         state = RECORDING;
         for (i = 0; i < MCR_LEN; i++) {
             k[i] = 0;
@@ -1650,12 +2765,17 @@ mcr(uint8_t cmd, uint8_t keycode)
             for (i = 0; i < MCR_LEN; i++)
                 mcr_chrd(PUT, fn_n, i, &m[i], &k[i]);
             state = IDLE;
+            arena_release(ARENA_MCR);
             blink(RECORD_MCR_OK_ON);
             break;
         }
         break;
     case CANCEL_MCR:
         state = IDLE;
+        arena_release(ARENA_MCR);
+        break;
+    case IS_RECORDING:
+        return state == RECORDING;
         break;
     }
     return false;
@@ -1685,6 +2805,47 @@ squeeze_chrd (uint8_t c)
     return even_bits | odd_bits | row<<4;
 }
 
+/*
+ * Keys down as far as TMK has passed their events on.  TMK calls
+ * hook_matrix_change() after action_exec(), so while an event is being
+ * processed its own key still has its previous state here.  The
+ * debounced matrix may hold further changes TMK will only report in
+ * later passes.
+ */
+static matrix_row_t keys_seen[MATRIX_ROWS];
+
+/*
+ * Number of keys currently down
+ */
+static int8_t
+keys_pressed(void)
+{
+    uint8_t row, n = 0;
+    matrix_row_t keys;
+
+    for (row = 0; row < MATRIX_ROWS; row++)
+        for (keys = keys_seen[row]; keys; keys &= keys - 1)
+            n++;
+    return n;
+}
+
+/*
+ * Overlay the layer of a LAYER_MOMENTARY thumb chord.  L_THB_HOLD
+ * keeps the bottom row in chord mode so we'll see its release.
+ */
+static uint8_t
+hold_layer_on(uint8_t thb_chrd)
+{
+    action_t a;
+
+    a.code = pgm_read_word((uint16_t *)thb_chrdmap + thb_chrd);
+    if (a.kind.id != ACT_FUNCTION || a.func.opt != LAYER_MOMENTARY)
+        return L_DFLT;
+    layer_on(a.func.id);
+    layer_on(L_THB_HOLD);
+    return a.func.id;
+}
+
 static uint8_t
 fn_chrdfunc(action_t a)
 {
@@ -1703,18 +2864,57 @@ fn_chrdfunc(action_t a)
     case PRINT:
         print_chrdmaps(PRINT_START);
         break;
+#if TRACE_LEN
+    case TRACE_DUMP:
+        print_chrdmaps(PRINT_TRACE);
+        break;
+#endif
+#if RTT_ROUNDS
+    case RTT_TEST:
+        rtt_start();
+        break;
+#endif
+#if CHRDMAP_PROFILES > 1
+    case NEXT_PROFILE:
+        next_profile();
+        break;
+#endif
     case RESET:
         print_chrdmaps(PRINT_CANCEL);
         mcr(CANCEL_MCR, 0);
         clear_keyboard();
         blink(RESET_ON);
         update_leds();          /* preempt LED usage */
-        wait_ms(10);
         break;
     }
     return false;
 }
 
+#if REPEAT_DELAY
+/*
+ * Keycode of the held chord and the weak mods it was first emitted
+ * with, including any one-shot mods consumed by then
+ */
+static struct {
+    uint16_t since;
+    uint16_t wait;
+    uint8_t mods;
+    uint8_t code;
+    bool armed :1;
+} rpt;
+
+static void
+rpt_capture(uint8_t weak_mods, uint8_t keycode)
+{
+    if (keycode >= KC_FN0 && keycode < KC_FN0 + MCR_MAX)
+        return;                 /* macros don't repeat */
+    if (mcr(IS_RECORDING, 0))
+        return;                 /* neither while being recorded */
+    rpt.mods = weak_mods;
+    rpt.code = keycode;
+}
+#endif
+
 static void
 emit_keycode(uint8_t weak_mods, uint8_t keycode, bool success_elsewhere)
 {
@@ -1729,46 +2929,144 @@ emit_keycode(uint8_t weak_mods, uint8_t keycode, bool success_elsewhere)
         if (!(keycode | success_elsewhere |
               get_weak_mods() | get_mods() | collecting_mcr))
             blink(NO_KEYCODE_ON);
+        bench_start(BENCH_REPORT);
         send_keyboard_report();
+        bench_end(BENCH_REPORT);
+        trace(TR_REPORT, keycode);
+#if TYPING_STATS
+        if (keycode)
+            wpm_count();
+#endif
     }
     clear_keyboard_but_mods();
-    blink(OFF(ALL_MODS));
+    blink_mods();
 }
 
+#if CORRECT_CHRDS
+/*
+ * Distance between a typed and a meant key within one column (0 =
+ * none, 1-3 = row); 0 for keys too far apart to be taken for each
+ * other.  Slipping to an adjacent row is likelier than a missed or
+ * an extra key.
+ */
+static const uint8_t key_dist[4][4] PROGMEM = {
+    /* meant: none    1  2  3 */
+    [0] = {0,         2, 2, 2},
+    [1] = {2,         0, 1, 0},
+    [2] = {2,         1, 0, 1},
+    [3] = {2,         0, 1, 0},
+};
+
+/*
+ * Mapped finger chord one column off fng_chrd at minimal distance;
+ * 0 if there is none or more than one
+ */
+static uint8_t
+correct_chrd(uint8_t fng_chrd, bool upper)
+{
+    uint8_t byte_pos, typed, meant, c, dist, best_dist = UINT8_MAX, best = 0;
+    bool ambiguous = false;
+    keypair_t kp;
+
+    for (byte_pos = 0; byte_pos < 8; byte_pos += 2) {
+        typed = fng_chrd>>byte_pos & 3;
+        for (meant = 0; meant < 4; meant++) {
+            if (!(dist = pgm_read_byte(&key_dist[typed][meant])))
+                continue;
+            if (!(c = (fng_chrd & ~(3<<byte_pos)) | meant<<byte_pos))
+                continue;
+            read_keypair(c, &kp);
+            if (upper ? !(kp.code_up || kp.mods_up) : !(kp.code_lo || kp.mods_lo))
+                continue;
+            if (dist < best_dist) {
+                best_dist = dist;
+                best = c;
+                ambiguous = false;
+            } else if (dist == best_dist) {
+                ambiguous = true;
+            }
+        }
+    }
+    return ambiguous ? 0 : best;
+}
+#endif
+
+#if ORD_CHRDS
+/*
+ * Replace *kp if fng_chrd has an ord_chrdmap entry for first
+ */
+static bool
+ord_keypair(uint8_t fng_chrd, uint8_t first, keypair_t *kp)
+{
+    uint8_t i;
+
+    for (i = 0; i < ORD_CHRDMAP_LEN; i++)
+        if (pgm_read_byte(&ord_chrdmap[i].chrd) == fng_chrd &&
+            pgm_read_byte(&ord_chrdmap[i].first) == first) {
+            memcpy_P(kp, &ord_chrdmap[i].keypair, sizeof(keypair_t));
+            return true;
+        }
+    return false;
+}
+#endif
+
 static uint8_t
-emit_chrd(uint8_t thb_chrd, uint8_t fng_chrd)
+emit_chrd(uint8_t thb_chrd, uint8_t fng_chrd, uint8_t first)
 {
     keypair_t keypair = {0};
     action_t thb_state = {0};
     uint8_t weak_mods = 0, keycode = 0, fn_chrd = 0, predicted_swap_state = IDLE;
-    bool mods_tap_only = false, thb_func = false;
+    bool mods_tap_only = false, func = false, ordered = false;
+#if USAGE_COUNTS
+    uint16_t used = USAGE_NONE;
+#endif
 
     thb_state.code = pgm_read_word((uint16_t *)thb_chrdmap + thb_chrd);
-    eeprom_read_block(&keypair, chrdmap + fng_chrd, sizeof(keypair_t));
+    read_keypair(fng_chrd, &keypair);
+#if ORD_CHRDS
+    ordered = ord_keypair(fng_chrd, first, &keypair);
+#endif
     if (thb_state.code == KC_NO) {
         /* plain finger chord from chrdmap */
         weak_mods = KEYPAIR_MODS_TO_MODS(keypair.mods_lo);
         keycode = keypair.code_lo;
-        predicted_swap_state = EXPECT_FNG_CHRD;
+        predicted_swap_state = ordered ? IDLE : EXPECT_FNG_CHRD;
+#if USAGE_COUNTS
+        used = USAGE_FNG + fng_chrd;
+#endif
     } else if (thb_state.code == THB_UP) {
         /* upper-level finger chord from chrdmap */
         weak_mods = KEYPAIR_MODS_TO_MODS(keypair.mods_up);
         keycode = keypair.code_up;
-        predicted_swap_state = EXPECT_FNG_CHRD;
+        predicted_swap_state = ordered ? IDLE : EXPECT_FNG_CHRD;
+#if USAGE_COUNTS
+        used = USAGE_FNG + fng_chrd;
+#endif
     } else if (thb_state.key.kind == ACT_MODS) {
         /* plain thumb chord from thb_chrdmap */
         weak_mods = thb_state.key.mods;
         keycode = thb_state.key.code;
         predicted_swap_state = IDLE;
+#if USAGE_COUNTS
+        used = USAGE_THB + thb_chrd;
+#endif
     } else if (thb_state.kind.id == ACT_FUNCTION) {
+#if USAGE_COUNTS
+        if (swap.state == IDLE)
+            usage_count(USAGE_THB + thb_chrd);
+#endif
         fn_chrdfunc(thb_state);
-        thb_func = true;
+        func = true;
         predicted_swap_state = IDLE;
     } else {                    /* fn_chrdmap */
         action_t fn_act;
 
         fn_chrd = squeeze_chrd(fng_chrd) | ((thb_state.key.code & 1)<<6);
-        fn_act.code = eeprom_read_word((uint16_t *)fn_chrdmap + fn_chrd);
+#if USAGE_COUNTS
+        if (swap.state == IDLE)
+            usage_count(USAGE_FN + fn_chrd);
+#endif
+        fn_act.code = ee_read_word((uint16_t *)fn_chrdmap + fn_chrd);
         switch (fn_act.kind.id) {
         case ACT_LMODS_TAP:
         case ACT_RMODS_TAP:
@@ -1796,6 +3094,7 @@ emit_chrd(uint8_t thb_chrd, uint8_t fng_chrd)
             if ((layer = fn_chrdfunc(fn_act))) {
                 return layer;   /* leave chord mode */
             }
+            func = true;
             predicted_swap_state = IDLE;
             break;
         }
@@ -1806,10 +3105,41 @@ emit_chrd(uint8_t thb_chrd, uint8_t fng_chrd)
             break;
         }
     }
+#if CORRECT_CHRDS
+    if (!keycode && !weak_mods && predicted_swap_state == EXPECT_FNG_CHRD &&
+        swap.state == IDLE) {
+        /* unmapped finger chord */
+        uint8_t c = correct_chrd(fng_chrd, thb_state.code == THB_UP);
+
+        if (c) {
+            read_keypair(c, &keypair);
+            if (thb_state.code == THB_UP) {
+                weak_mods = KEYPAIR_MODS_TO_MODS(keypair.mods_up);
+                keycode = keypair.code_up;
+            } else {
+                weak_mods = KEYPAIR_MODS_TO_MODS(keypair.mods_lo);
+                keycode = keypair.code_lo;
+            }
+            count(STAT_CORRECTED);
+#if USAGE_COUNTS
+            used = USAGE_FNG + c;
+#endif
+        }
+    }
+#endif
+    trace(TR_EMIT, keycode);
     switch (swap.state) {
     case IDLE:
-        if (!mods_tap_only)
-            emit_keycode(weak_mods, keycode, thb_func);
+#if USAGE_COUNTS
+        if (used != USAGE_NONE)
+            usage_count(used);
+#endif
+        if (!mods_tap_only) {
+#if REPEAT_DELAY
+            rpt_capture(weak_mods | get_weak_mods(), keycode);
+#endif
+            emit_keycode(weak_mods, keycode, func);
+        }
         blink_mods();
         break;
     case EXPECT_FIRST_CHRD:
@@ -1856,32 +3186,175 @@ emit_chrd(uint8_t thb_chrd, uint8_t fng_chrd)
     return 0;
 }
 
+/*
+ * Chord collected by action_function()
+ */
+static struct {
+    uint8_t fng;
+    uint8_t thb;
+    uint8_t hold_layer;
+    uint8_t first;              /* column pressed first, 0 = leftmost */
+    int8_t keys_down;
+    int8_t layer;
+    bool ready :1;
+    bool layer_pending :1;
+    bool hold_used :1;          /* a key was pressed on the held layer */
+#if HYBRID_WINDOW_US
+    bool window_open :1;
+    uint16_t window_start;
+    uint16_t typed;             /* held keys hybrid_chrd() has typed */
+#endif
+} chrd = {.hold_layer = L_DFLT, .ready = true};
+
+/*
+ * Emit the collected chord, and ignore further keys until all are
+ * released
+ */
+static void
+commit_chrd(void)
+{
+    trace(TR_COMMIT, chrd.fng);
+#if TYPING_STATS
+    tm_commit();
+#endif
+    dlog(CHRD, DLOG_DEBUG, "chord ");
+    dlog_hex(CHRD, DLOG_DEBUG, chrd.thb);
+    dlog_hex(CHRD, DLOG_DEBUG, chrd.fng);
+    dlog(CHRD, DLOG_DEBUG, "\n");
+    bench_start(BENCH_EMIT);
+    if ((chrd.layer = emit_chrd(chrd.thb, chrd.fng, chrd.first)))
+        chrd.layer_pending = true; /* any layer but L_DFLT */
+    bench_end(BENCH_EMIT);
+    chrd.ready = false;
+}
+
+#if HYBRID_WINDOW_US
+#define TYPED_BIT(row, col) ((uint16_t)1<<(((row) - 1) * MATRIX_COLS + (col)))
+
+/*
+ * Type a lone finger key once no second key has joined it within
+ * HYBRID_WINDOW_US.  Keys pressed while it is still held start a new
+ * chord.
+ */
+static void
+hybrid_chrd(void)
+{
+    if (chrd.window_open &&
+        utimer_elapsed(chrd.window_start) >= US_TO_UTICKS(HYBRID_WINDOW_US)) {
+        chrd.window_open = false;
+        commit_chrd();
+        if (!chrd.layer_pending) {
+            uint8_t col = MATRIX_COLS - 1 - chrd.first;
+
+            chrd.typed |= TYPED_BIT(chrd.fng>>(col * 2) & 3, col);
+            chrd.keys_down = 0;
+            chrd.ready = true;
+            chrd.fng = 0;
+        }
+    }
+}
+#endif
+
+#if REPEAT_DELAY
+/*
+ * Type a chord whose keys are all still held after REPEAT_DELAY, then
+ * keep typing its keycode every REPEAT_INTERVAL until a key is
+ * released
+ */
+static void
+repeat_chrd(void)
+{
+    if (!rpt.armed || timer_elapsed(rpt.since) < rpt.wait)
+        return;
+    /* a lone key typed by hybrid_chrd() leaves chrd ready for the
+       next chord but rpt.code set */
+    if (rpt.code)
+        emit_keycode(rpt.mods, rpt.code, false);
+    else if (chrd.ready && chrd.fng)
+        commit_chrd();
+    rpt.armed = rpt.code;
+    rpt.since = timer_read();
+    rpt.wait = REPEAT_INTERVAL;
+}
+#endif
+
+/*
+ * Poll chord timers while keys are held
+ */
+static uint16_t
+chrd_task(void)
+{
+#if HYBRID_WINDOW_US
+    hybrid_chrd();
+#endif
+#if REPEAT_DELAY
+    repeat_chrd();
+    if (rpt.armed)
+        return SCHED_ASAP;
+#endif
+    return chrd.keys_down > 0 ? SCHED_ASAP : SCHED_IDLE;
+}
+
 void
 action_function(keyrecord_t *record, uint8_t id, uint8_t opt)
 {
-    static uint8_t fng_chrd = 0, thb_chrd = 0;
-    static int8_t keys_down = 0, layer = 0;
-    static bool ready = true, layer_pending = false;
     keyevent_t e = record->event;
     uint8_t func_id = opt, row, col;
     keycoord_t keycoords;
 
+    bench_start(BENCH_DECODE);
     keycoords.raw = id;
     row = keycoords.key.row;
     col = keycoords.key.col;
     if (e.pressed) {
-        keys_down++;
-        if (ready) { /* all remaining keys from previous chord released */
+        chrd.keys_down++;
+#if HYBRID_WINDOW_US || REPEAT_DELAY
+        sched_wake(TASK_CHRD);
+#endif
+#if HYBRID_WINDOW_US
+        chrd.window_open = false;
+#endif
+#if REPEAT_DELAY
+        if (chrd.ready) {
+            rpt.armed = true;
+            rpt.code = KC_NO;
+            rpt.since = timer_read();
+            rpt.wait = REPEAT_DELAY;
+        }
+#endif
+        if (chrd.ready) { /* all remaining keys from previous chord released */
+#if TYPING_STATS
+            tm_press(chrd.keys_down == 1);
+#endif
             switch (func_id) {
             case THB_CHRD:    /* collect bottom row keys seperately */
-                thb_chrd |= 1<<col;
+                chrd.thb |= 1<<col;
+                if (chrd.hold_layer && !chrd.hold_used) {
+                    /* nothing typed on the layer yet; the thumb chord
+                       is still growing, e.g. into RESET */
+                    layer_off(L_THB_HOLD);
+                    layer_off(chrd.hold_layer);
+                    chrd.hold_layer = L_DFLT;
+                }
+                if (!chrd.fng && !chrd.hold_layer) {
+                    chrd.hold_layer = hold_layer_on(chrd.thb);
+                    chrd.hold_used = false;
+                }
                 break;
             case FNG_CHRD:      /* finger keys: top three rows */
             {
                 uint8_t byte_pos = col * 2;
 
-                fng_chrd &= ~(3<<byte_pos);
-                fng_chrd |= row<<byte_pos;
+                if (!chrd.fng)
+                    chrd.first = MATRIX_COLS - 1 - col;
+                chrd.fng &= ~(3<<byte_pos);
+                chrd.fng |= row<<byte_pos;
+#if HYBRID_WINDOW_US
+                if (chrd.keys_down == 1 && swap.state == IDLE) {
+                    chrd.window_open = true;
+                    chrd.window_start = utimer_read();
+                }
+#endif
                 break;
             }
             case MCR_PLAY:      /* non-chord macro pad key */
@@ -1892,7 +3365,7 @@ action_function(keyrecord_t *record, uint8_t id, uint8_t opt)
                 uint8_t layer = id;
 
                 layer_on(layer);
-                keys_down = 0;
+                chrd.keys_down = 0;
             }
             }
         }
@@ -1901,37 +3374,201 @@ action_function(keyrecord_t *record, uint8_t id, uint8_t opt)
             uint8_t layer = id;
 
             layer_off(layer);
-            keys_down = 0;
+            chrd.keys_down = 0;
+#if HYBRID_WINDOW_US
+        } else if (func_id == FNG_CHRD && chrd.typed & TYPED_BIT(row, col)) {
+            /* typed by hybrid_chrd() already, part of no chord */
+            chrd.typed &= ~TYPED_BIT(row, col);
+#if REPEAT_DELAY
+            if (!chrd.keys_down)
+                rpt.armed = false;
+#endif
+#endif
         } else {
-            if (ready) {
+#if HYBRID_WINDOW_US
+            chrd.window_open = false;
+#endif
+#if REPEAT_DELAY
+            rpt.armed = false;
+#endif
+            if (chrd.hold_layer) {   /* held thumb chord released */
+                layer_off(L_THB_HOLD);
+                layer_off(chrd.hold_layer);
+                chrd.hold_layer = L_DFLT;
+                clear_keyboard_but_mods();
+                blink_mods();
+                /* finger keys on the held layer weren't counted;
+                   the key being released is still among them */
+                chrd.keys_down = keys_pressed();
+                chrd.ready = false;
+            }
+            if (chrd.ready) {
                 if (func_id == MCR_PLAY) {
                     /* ignored on key release */
+                    chrd.ready = false;
                 } else if (func_id == CHG_LAYER) {
                     /* leave or keep out of chord mode */
-                    layer = id;
-                    layer_pending = true;
-                } else if ((layer = emit_chrd(thb_chrd, fng_chrd))) {
-                    /* any layer but L_DFLT */
-                    layer_pending = true;
+                    chrd.layer = id;
+                    chrd.layer_pending = true;
+                    chrd.ready = false;
+                } else {
+                    commit_chrd();
                 }
-                ready = false;
             }
-            if (--keys_down <= 0) {
+            if (--chrd.keys_down <= 0) {
                 /* keys_down < 0 if there are pressed keys while leaving
                    non-chord mode */
-                keys_down = 0;
-                ready = true;
-                fng_chrd = 0;
-                thb_chrd = 0;
-                if (layer_pending) {         /* leave chord mode */
+                chrd.keys_down = 0;
+                chrd.ready = true;
+                chrd.fng = 0;
+                chrd.thb = 0;
+                if (chrd.layer_pending) {         /* leave chord mode */
                     blink(CHG_LAYER_ON);
-                    layer_move(layer);
-                    layer_pending = false;
+                    layer_move(chrd.layer);
+                    chrd.layer_pending = false;
                 }
             }
         }
     }
+    bench_end(BENCH_DECODE);
+}
+
+
+#if FAST_BOOT
+/*************************************************************
+ * Fast boot
+ *************************************************************/
+/*
+ * TMK doesn't scan the matrix before USB enumeration has finished.
+ * Until then, the Timer1 compare B interrupt scans it every ms,
+ * debounces, and queues the key events; hook_late_init() feeds them to
+ * TMK the way keyboard_task() would.  Keys still held by then are
+ * left to TMK's first scan.
+ */
+#define BOOT_SCAN_PERIOD US_TO_UTICKS(1000)
+
+void matrix_select_col(uint8_t col);
+void matrix_unselect_cols(void);
+uint8_t matrix_read_rows(void);
+
+static struct {
+    uint16_t ms;                /* since hook_early_init() */
+    uint8_t stable;             /* ms since raw last changed */
+    uint8_t len;
+    matrix_row_t raw[MATRIX_ROWS];
+    matrix_row_t state[MATRIX_ROWS];
+} boot;
+
+static void
+boot_init(void)
+{
+    arena_claim(ARENA_BOOT);
+    matrix_init();
+    OCR1B = utimer_read() + BOOT_SCAN_PERIOD;
+    TIFR1 = 1<<OCF1B;
+    TIMSK1 |= 1<<OCIE1B;
+}
+
+/*
+ * Queue the differences between debounced raw and state
+ */
+static void
+boot_commit(void)
+{
+    uint8_t row, col;
+    matrix_row_t chg;
+
+    for (row = 0; row < MATRIX_ROWS; row++) {
+        chg = boot.raw[row] ^ boot.state[row];
+        for (col = 0; col < MATRIX_COLS; col++) {
+            if (!(chg & (matrix_row_t)1<<col))
+                continue;
+            if (boot.len < FAST_BOOT)
+                arena.boot.event[boot.len++] =
+                    (bool)(boot.raw[row] & (matrix_row_t)1<<col)<<7 | row<<4 | col;
+            else
+                count(STAT_BOOT_LOST);
+        }
+        boot.state[row] = boot.raw[row];
+    }
+}
+
+ISR(TIMER1_COMPB_vect)
+{
+    uint8_t row, col, rows;
+    bool changed = false;
+
+    OCR1B += BOOT_SCAN_PERIOD;
+    sei();                      /* let USB and the LEDs in */
+    boot.ms++;
+    for (col = 0; col < MATRIX_COLS; col++) {
+        matrix_select_col(col);
+        wait_us(MATRIX_SETTLE_US);
+        rows = matrix_read_rows();
+        matrix_unselect_cols();
+        for (row = 0; row < MATRIX_ROWS; row++) {
+            if ((bool)(rows & 1<<row) != (bool)(boot.raw[row] & (matrix_row_t)1<<col)) {
+                boot.raw[row] ^= (matrix_row_t)1<<col;
+                changed = true;
+            }
+        }
+    }
+    if (changed)
+        boot.stable = 0;
+    else if (boot.stable < DEBOUNCE)
+        boot.stable++;
+    else
+        boot_commit();
+}
+
+static void
+boot_key(uint8_t row, uint8_t col, bool pressed)
+{
+    keyevent_t e = {
+        .key = {.row = row, .col = col},
+        .pressed = pressed,
+        .time = timer_read() | 1,
+    };
+
+    action_exec(e);
+    hook_matrix_change(e);
+}
+
+/*
+ * Stop scanning and replay the queue, except for the last press of
+ * each key still held.  Should the queue have overflowed, release what
+ * is left pressed.
+ */
+static void
+boot_flush(void)
+{
+    matrix_row_t down[MATRIX_ROWS] = {0};
+    uint8_t i, j, ev, row, col;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        TIMSK1 &= ~(1<<OCIE1B);
+    }
+    stats[STAT_BOOT_USB_MS] = boot.ms;
+    stats[STAT_BOOT_KEYS] = boot.len;
+    for (i = 0; i < boot.len; i++) {
+        ev = arena.boot.event[i];
+        row = ev>>4 & 7;
+        col = ev & 0xf;
+        for (j = i + 1; j < boot.len; j++)
+            if (!((arena.boot.event[j] ^ ev) & 0x7f))
+                break;
+        if (j == boot.len && boot.state[row] & (matrix_row_t)1<<col)
+            continue;
+        down[row] ^= (matrix_row_t)1<<col;
+        boot_key(row, col, ev & 0x80);
+    }
+    arena_release(ARENA_BOOT);
+    for (row = 0; row < MATRIX_ROWS; row++)
+        for (col = 0; col < MATRIX_COLS; col++)
+            if (down[row] & (matrix_row_t)1<<col)
+                boot_key(row, col, false);
 }
+#endif
 
 
 /*************************************************************
@@ -1940,8 +3577,12 @@ action_function(keyrecord_t *record, uint8_t id, uint8_t opt)
 void
 hook_early_init(void)
 {
+    utimer_init();
     led_init();
     led(8, ON);
+#if FAST_BOOT
+    boot_init();
+#endif
 }
 
 void
@@ -1949,23 +3590,109 @@ hook_late_init(void)
 {
     led(8, OFF);
     blink(RESET_ON);
+#if FAST_BOOT
+    boot_flush();
+#endif
+}
+
+static uint16_t (* const task_func[TASKS])(void) = {
+    [TASK_CHRD] = chrd_task,
+    [TASK_LEDS] = leds_task,
+    [TASK_EEPROM] = eeprom_task,
+    [TASK_PRINT] = print_task,
+#if RTT_ROUNDS
+    [TASK_RTT] = rtt_task,
+#endif
+};
+
+static void
+run_tasks(void)
+{
+    uint8_t i;
+    uint16_t start, wait, next;
+#if PROFILE
+    uint16_t ran;
+#endif
+
+    if (!sched_pending && !(TIFR1 & 1<<OCF1B))
+        return;                 /* nothing due */
+    sched_pending = false;
+    TIFR1 = 1<<OCF1B;
+    start = utimer_read();
+    next = start + SCHED_HORIZON;
+    for (i = 0; i < TASKS; i++) {
+        if (!tasks[i].armed)
+            continue;
+        if ((int16_t)(utimer_read() - tasks[i].due) >= 0) {
+            if (utimer_elapsed(start) > SCHED_BUDGET) {
+                sched_pending = true;
+                continue;
+            }
+#if PROFILE
+            ran = utimer_read();
+#endif
+            wait = task_func[i]();
+#if PROFILE
+            prof_add(PROF_TASK + i, utimer_elapsed(ran));
+#endif
+            if (wait == SCHED_IDLE) {
+                tasks[i].armed = false;
+                continue;
+            }
+            tasks[i].due = utimer_read() + (wait < SCHED_HORIZON ? wait : SCHED_HORIZON);
+        }
+        if ((int16_t)(tasks[i].due - next) < 0)
+            next = tasks[i].due;
+    }
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        OCR1B = next;
+    }
+    if ((int16_t)(utimer_read() - next) >= 0)
+        sched_pending = true;   /* too late for OCR1B */
 }
 
 void
 hook_keyboard_loop(void)
 {
-    update_leds();
-    print_chrdmaps(PRINT_NEXT);
+    static uint16_t last;
+    static bool started = false;
+    uint16_t period = utimer_elapsed(last);
+
+    last = utimer_read();
+    if (started) {
+        stat_max(STAT_MAX_LOOP_US, uticks_to_us(period));
+#if PROFILE
+        prof_add(PROF_LOOP, period);
+        prof_add(PROF_SCAN, matrix_scan_end - matrix_scan_start);
+        prof_add(PROF_ACTION, last - matrix_scan_end);
+#endif
+    }
+    started = true;
+#if TRACE_LEN
+    trace_idle();
+#endif
+    run_tasks();
+    dlog_drain();
 }
 
 void
 hook_matrix_change(keyevent_t event)
 {
+    if (event.pressed)
+        keys_seen[event.key.row] |= (matrix_row_t)1<<event.key.col;
+    else
+        keys_seen[event.key.row] &= ~((matrix_row_t)1<<event.key.col);
+    if (event.pressed && chrd.hold_layer && event.key.row < MATRIX_ROWS - 1)
+        chrd.hold_used = true;
+    trace(TR_KEY, event.pressed<<7 | event.key.row<<4 | event.key.col);
 }
 
 void
 hook_keyboard_leds_change(uint8_t led_status)
 {
+#if RTT_ROUNDS
+    rtt_echo(led_status);
+#endif
     blink_mods();
 }
 
@@ -0,0 +1,186 @@
+#include "action_layer.h"
+#include "dlog.h"
+#include "host.h"
+#include "led.h"
+#include "leds.h"
+#include "lufa.h"
+#include "matrix.h"
+#include "report.h"
+#include "timer.h"
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
+
+
+/* NaN-15 scan rate and report rate benchmark
+ *
+ * Repeats, every few seconds:
+ *
+ *   scan     matrix_scan() in a tight loop for a second: scans/s
+ *   report   empty keyboard reports for a second, each as soon as the
+ *            host has taken the previous one: reports/s at the
+ *            endpoint's polling interval
+ *   loop     a second of regular main loop passes: period min, average,
+ *            and max in us, max - min being the jitter
+ *
+ * Results go to the console (CONSOLE_ENABLE) as one line per round.
+ * The LEDs show a bar graph, one LED per SCANS_PER_LED scans/s while
+ * the loop is measured, and one per REPORTS_PER_LED reports/s
+ * afterwards.
+ */
+const uint8_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
+    [0] = {
+        {KC_NO, KC_NO, KC_NO, KC_NO},
+        {KC_NO, KC_NO, KC_NO, KC_NO},
+        {KC_NO, KC_NO, KC_NO, KC_NO},
+        {KC_NO, KC_NO, KC_NO, KC_NO},
+    },
+};
+
+const uint16_t PROGMEM fn_actions[] = {
+};
+
+#define SCANS_PER_LED 1000
+#define REPORTS_PER_LED 100
+
+static void
+led_bar(uint32_t n)
+{
+    led_ports_range(0, n < 12 ? n : 12);
+}
+
+void
+led_set(uint8_t usb_led)
+{
+}
+
+/*
+ * Timer1 at F_CPU/8 times loop passes in 0.5us ticks
+ */
+#define TICKS_PER_US 2
+
+static uint16_t
+ticks(void)
+{
+    uint16_t t;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        t = TCNT1;
+    }
+    return t;
+}
+
+enum phase {SCAN, REPORT, LOOP, SHOW};
+
+static enum phase phase = SCAN;
+static uint16_t phase_start;
+static uint32_t scans;
+static uint16_t reports;
+static struct {
+    uint16_t last;
+    uint16_t min;
+    uint16_t max;
+    uint32_t sum;
+    uint16_t n;
+} loop;
+
+static void
+bench_scan(void)
+{
+    uint16_t start = timer_read();
+
+    for (scans = 0; timer_elapsed(start) < 1000; scans++)
+        matrix_scan();
+}
+
+/*
+ * Send whenever the endpoint bank is free again, i.e. once per host
+ * poll
+ */
+static void
+bench_report(void)
+{
+    report_keyboard_t report = {0};
+    uint16_t start = timer_read();
+    bool free;
+
+    for (reports = 0; timer_elapsed(start) < 1000;) {
+        if (USB_DeviceState != DEVICE_STATE_Configured)
+            continue;
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            Endpoint_SelectEndpoint(KEYBOARD_IN_EPNUM);
+            free = Endpoint_IsReadWriteAllowed();
+        }
+        if (free) {
+            host_keyboard_send(&report);
+            reports++;
+        }
+    }
+}
+
+static void
+print_results(void)
+{
+    dlog(SCANBENCH, DLOG_INFO, "scans/s ");
+    dlog_dec(SCANBENCH, DLOG_INFO, scans);
+    dlog(SCANBENCH, DLOG_INFO, " reports/s ");
+    dlog_dec(SCANBENCH, DLOG_INFO, reports);
+    dlog(SCANBENCH, DLOG_INFO, " loop us ");
+    dlog_dec(SCANBENCH, DLOG_INFO, loop.min / TICKS_PER_US);
+    dlog(SCANBENCH, DLOG_INFO, " ");
+    dlog_dec(SCANBENCH, DLOG_INFO, loop.n ? loop.sum / loop.n / TICKS_PER_US : 0);
+    dlog(SCANBENCH, DLOG_INFO, " ");
+    dlog_dec(SCANBENCH, DLOG_INFO, loop.max / TICKS_PER_US);
+    dlog(SCANBENCH, DLOG_INFO, "\n");
+}
+
+void
+hook_late_init(void)
+{
+    TCCR1A = 0;
+    TCCR1B = 1<<CS11;           /* F_CPU/8 */
+    led_ports_init();
+}
+
+void
+hook_keyboard_loop(void)
+{
+    uint16_t now = ticks(), period = now - loop.last;
+
+    loop.last = now;
+    dlog_drain();
+    switch (phase) {
+    case SCAN:
+        bench_scan();
+        phase = REPORT;
+        break;
+    case REPORT:
+        bench_report();
+        loop.min = UINT16_MAX;
+        loop.max = 0;
+        loop.sum = 0;
+        loop.n = 0;
+        led_bar(scans / SCANS_PER_LED);
+        phase = LOOP;
+        phase_start = timer_read();
+        loop.last = ticks();
+        break;
+    case LOOP:
+        if (period < loop.min)
+            loop.min = period;
+        if (period > loop.max)
+            loop.max = period;
+        loop.sum += period;
+        loop.n++;
+        if (timer_elapsed(phase_start) >= 1000) {
+            led_bar(reports / REPORTS_PER_LED);
+            print_results();
+            phase = SHOW;
+            phase_start = timer_read();
+        }
+        break;
+    case SHOW:
+        if (timer_elapsed(phase_start) >= 1000 && dlog_idle())
+            phase = SCAN;
+        break;
+    }
+}
@@ -0,0 +1,390 @@
+#include "action_layer.h"
+#include "action_util.h"
+#include "dlog.h"
+#include "led.h"
+#include "leds.h"
+#include "matrix.h"
+#include "timer.h"
+#include <avr/pgmspace.h>
+#include <stdio.h>
+#include <util/atomic.h>
+#include <util/delay.h>
+
+
+/* NaN-15 matrix self-test
+ *
+ * Press and release every key once, one at a time, holding each for
+ * about a second.  For each key, this measures
+ *
+ *   settle   how long its row takes to follow the column after the
+ *            column is selected and after it is unselected, against
+ *            MATRIX_SETTLE_US
+ *   bounce   first to last edge on press and on release, against
+ *            DEBOUNCE
+ *   latency  first edge to matrix_scan() reporting the change
+ *
+ * The LEDs fill up as keys are done.  After the last key, the keyboard
+ * types a report with pass/fail per key and the fastest safe
+ * MATRIX_SETTLE_US and DEBOUNCE for this unit, and walks the 12 LEDs.
+ * Then the next round begins.
+ */
+const uint8_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
+    [0] = {
+        {KC_NO, KC_NO, KC_NO, KC_NO},
+        {KC_NO, KC_NO, KC_NO, KC_NO},
+        {KC_NO, KC_NO, KC_NO, KC_NO},
+        {KC_NO, KC_NO, KC_NO, KC_NO},
+    },
+};
+
+const uint16_t PROGMEM fn_actions[] = {
+};
+
+void matrix_select_col(uint8_t col);
+void matrix_unselect_cols(void);
+uint8_t matrix_read_rows(void);
+
+#define NO_SWITCH_ROW 3         /* matrix position without a switch */
+#define NO_SWITCH_COL 1
+#define KEYS 15
+
+void
+led_set(uint8_t usb_led)
+{
+}
+
+/*
+ * Time in Timer1 ticks of 0.5us; call at least every 32ms
+ */
+#define TICKS_PER_US 2
+
+static uint32_t clock;
+static uint16_t clock_last;
+
+static uint32_t
+now(void)
+{
+    uint16_t t;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        t = TCNT1;
+    }
+    clock += (uint16_t)(t - clock_last);
+    clock_last = t;
+    return clock;
+}
+
+static uint16_t
+ticks_to_us(uint32_t ticks)
+{
+    ticks /= TICKS_PER_US;
+    return ticks < UINT16_MAX ? ticks : UINT16_MAX;
+}
+
+/*
+ * Measurements
+ */
+#define SETTLE_SAMPLES 16
+#define SETTLE_LIMIT (200 * TICKS_PER_US)
+#define BURST 32                /* row samples per matrix_scan() */
+#define QUIET_US 20000UL
+#define EDGE_MAX_US 2000000UL
+#define HOLD_MAX_MS 10000
+
+static struct {
+    uint16_t settle;            /* ticks; worst of select and unselect */
+    uint16_t bounce[2];         /* us; press, release */
+    uint16_t latency[2];        /* us; UINT16_MAX if never reported */
+    bool done;
+} keys[MATRIX_ROWS][MATRIX_COLS];
+
+static uint8_t keys_done;
+
+static bool
+row_low(uint8_t row)
+{
+    return matrix_read_rows() & 1<<row;
+}
+
+/*
+ * Ticks until the row reads low, or high
+ */
+static uint16_t
+follow(uint8_t row, bool low)
+{
+    uint16_t t0 = TCNT1, t;
+
+    do
+        t = TCNT1 - t0;
+    while (row_low(row) != low && t < SETTLE_LIMIT);
+    return t;
+}
+
+static uint16_t
+settle(uint8_t row, uint8_t col)
+{
+    uint16_t t, worst = 0;
+    uint8_t i;
+
+    for (i = 0; i < SETTLE_SAMPLES; i++) {
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            matrix_unselect_cols();
+            _delay_us(100);
+            matrix_select_col(col);
+            if ((t = follow(row, true)) > worst)
+                worst = t;
+            _delay_us(100);
+            matrix_unselect_cols();
+            if ((t = follow(row, false)) > worst)
+                worst = t;
+        }
+        now();
+    }
+    return worst;
+}
+
+/*
+ * Follow a key's edge from its first change until it has been quiet
+ * for QUIET_US, running the normal matrix_scan() between bursts of
+ * samples
+ */
+static void
+edge(uint8_t row, uint8_t col, bool pressed)
+{
+    uint32_t first = now(), last = first, detected = 0, t;
+    bool state = pressed;
+    uint8_t i;
+
+    do {
+        matrix_select_col(col);
+        _delay_us(MATRIX_SETTLE_US);
+        for (i = 0; i < BURST; i++)
+            if (row_low(row) != state) {
+                state = !state;
+                last = now();
+            }
+        matrix_unselect_cols();
+        matrix_scan();
+        t = now();
+        if (!detected && (bool)(matrix_get_row(row) & 1<<col) == pressed)
+            detected = t;
+    } while ((!detected || t - last < QUIET_US * TICKS_PER_US) &&
+             t - first < EDGE_MAX_US * TICKS_PER_US);
+    keys[row][col].bounce[!pressed] = ticks_to_us(last - first);
+    keys[row][col].latency[!pressed] = detected ? ticks_to_us(detected - first) : UINT16_MAX;
+}
+
+static bool
+key_down(uint8_t row, uint8_t col)
+{
+    bool down;
+
+    matrix_select_col(col);
+    _delay_us(MATRIX_SETTLE_US);
+    down = row_low(row);
+    matrix_unselect_cols();
+    return down;
+}
+
+static void
+test_key(uint8_t row, uint8_t col)
+{
+    uint16_t since;
+
+    led_ports_range(0, 0);
+    edge(row, col, true);
+    keys[row][col].settle = settle(row, col);
+    for (since = timer_read(); key_down(row, col) && timer_elapsed(since) < HOLD_MAX_MS;)
+        now();
+    edge(row, col, false);
+    if (!keys[row][col].done) {
+        keys[row][col].done = true;
+        keys_done++;
+    }
+    led_ports_range(0, keys_done * 12 / KEYS);
+}
+
+static bool
+passed(uint8_t row, uint8_t col)
+{
+    return keys[row][col].settle < MATRIX_SETTLE_US * TICKS_PER_US &&
+        keys[row][col].bounce[0] < DEBOUNCE * 1000U &&
+        keys[row][col].bounce[1] < DEBOUNCE * 1000U &&
+        keys[row][col].latency[0] != UINT16_MAX &&
+        keys[row][col].latency[1] != UINT16_MAX;
+}
+
+/*
+ * Typing the report: one character per loop pass
+ */
+#define LINEBUFLEN 64
+
+static char linebuf[LINEBUFLEN];
+static uint8_t line, bufpos;
+static bool typing;
+
+static uint8_t
+keycode(char c)
+{
+    if (c >= 'a' && c <= 'z')
+        return KC_A + c - 'a';
+    if (c >= '1' && c <= '9')
+        return KC_1 + c - '1';
+    switch (c) {
+    case '0': return KC_0;
+    case ' ': return KC_SPACE;
+    case '\n': return KC_ENTER;
+    case '.': return KC_DOT;
+    case '-': return KC_MINUS;
+    }
+    return KC_NO;
+}
+
+/*
+ * Fill linebuf with report line n; false past the last one
+ */
+static bool
+fmt_line(uint8_t n)
+{
+    uint8_t row, col;
+    uint16_t worst_settle = 0, worst_bounce = 0;
+
+    if (n == 0) {
+        snprintf(linebuf, LINEBUFLEN, "nan-15 selftest  settle %u us  debounce %u ms\n",
+                 MATRIX_SETTLE_US, DEBOUNCE);
+        return true;
+    }
+    if (n == 1) {
+        snprintf(linebuf, LINEBUFLEN, "key   settle us  bounce us dn up  latency us dn up\n");
+        return true;
+    }
+    n -= 2;
+    if (n < MATRIX_ROWS * MATRIX_COLS) {
+        row = n / MATRIX_COLS;
+        col = n % MATRIX_COLS;
+        if (row == NO_SWITCH_ROW && col == NO_SWITCH_COL) {
+            linebuf[0] = '\0';
+            return true;
+        }
+        snprintf(linebuf, LINEBUFLEN, "r%uc%u  %5u.%u  %5u %5u  %5u %5u  %s\n", row, col,
+                 keys[row][col].settle / TICKS_PER_US, keys[row][col].settle % TICKS_PER_US * 5,
+                 keys[row][col].bounce[0], keys[row][col].bounce[1],
+                 keys[row][col].latency[0], keys[row][col].latency[1],
+                 passed(row, col) ? "ok" : "fail");
+        return true;
+    }
+    if (n == MATRIX_ROWS * MATRIX_COLS) {
+        for (row = 0; row < MATRIX_ROWS; row++)
+            for (col = 0; col < MATRIX_COLS; col++) {
+                if (row == NO_SWITCH_ROW && col == NO_SWITCH_COL)
+                    continue;
+                if (keys[row][col].settle > worst_settle)
+                    worst_settle = keys[row][col].settle;
+                if (keys[row][col].bounce[0] > worst_bounce)
+                    worst_bounce = keys[row][col].bounce[0];
+                if (keys[row][col].bounce[1] > worst_bounce)
+                    worst_bounce = keys[row][col].bounce[1];
+            }
+        /* twice the worst settle time (in ticks, that's the tick count),
+           and the worst bounce plus 1 to 2ms */
+        snprintf(linebuf, LINEBUFLEN, "fastest safe  settle %u us  debounce %u ms\n\n",
+                 worst_settle + 1, worst_bounce / 1000 + 2);
+        return true;
+    }
+    return false;
+}
+
+static void
+type_next(void)
+{
+    uint8_t code;
+
+    while (!linebuf[bufpos]) {
+        bufpos = 0;
+        if (!fmt_line(line++)) {
+            typing = false;
+            return;
+        }
+    }
+    if ((code = keycode(linebuf[bufpos++]))) {
+        add_key(code);
+        send_keyboard_report();
+        clear_keyboard();
+    }
+}
+
+/*
+ * LED walk, one LED per WALK_MS
+ */
+#define WALK_MS 150
+
+static uint8_t walk_led = 12;
+static uint16_t walk_since;
+
+static void
+walk_leds(void)
+{
+    if (timer_elapsed(walk_since) < WALK_MS)
+        return;
+    walk_since = timer_read();
+    walk_led++;
+    led_ports_range(walk_led, walk_led + 1);
+}
+
+static void
+start_walk(void)
+{
+    walk_led = 0;
+    walk_since = timer_read();
+    led_ports_range(0, 1);
+}
+
+void
+hook_late_init(void)
+{
+    TCCR1A = 0;
+    TCCR1B = 1<<CS11;           /* F_CPU/8 */
+    led_ports_init();
+    start_walk();
+}
+
+void
+hook_keyboard_loop(void)
+{
+    uint8_t row, col;
+
+    dlog_drain();
+    if (walk_led < 12) {
+        walk_leds();
+        return;
+    }
+    if (typing) {
+        type_next();
+        if (!typing) {
+            for (row = 0; row < MATRIX_ROWS; row++)
+                for (col = 0; col < MATRIX_COLS; col++)
+                    keys[row][col].done = false;
+            keys_done = 0;
+            start_walk();
+        }
+        return;
+    }
+    for (col = 0; col < MATRIX_COLS; col++) {
+        matrix_select_col(col);
+        _delay_us(MATRIX_SETTLE_US);
+        for (row = 0; row < MATRIX_ROWS; row++)
+            if (row_low(row) && !(row == NO_SWITCH_ROW && col == NO_SWITCH_COL)) {
+                matrix_unselect_cols();
+                test_key(row, col);
+                goto scanned;
+            }
+        matrix_unselect_cols();
+    }
+scanned:
+    if (keys_done == KEYS) {
+        line = 0;
+        bufpos = 0;
+        linebuf[0] = '\0';
+        typing = true;
+    }
+}
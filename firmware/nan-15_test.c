@@ -1,4 +1,5 @@
 #include "action_layer.h"
+#include "dlog.h"
 #include "led.h"
 #include <avr/pgmspace.h>
 
@@ -110,3 +111,9 @@ led_set(uint8_t usb_led)
         PORTB &= ~(1<<0);
     }
 }
+
+void
+hook_keyboard_loop(void)
+{
+    dlog_drain();
+}
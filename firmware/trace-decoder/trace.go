@@ -0,0 +1,132 @@
+// Print a timeline from a trace typed by the NaN-15 chord firmware, or
+// its key events as a script for the host build's replay harness
+package main
+
+import (
+	"bufio"
+	"flag"
+	"fmt"
+	"log"
+	"os"
+	"regexp"
+	"strconv"
+)
+
+var (
+	inFilename = flag.String("i", "-", "input filename (\"-\" for stdin)")
+	keyScript  = flag.Bool("k", false, "print key events as a replay script")
+	recordRx   = regexp.MustCompile(`^ +([0-9a-f]{4}) ([0-9a-f]) ([0-9a-f]{2})$`)
+)
+
+const (
+	usPerTick   = 4
+	halfPeriod  = 0x8000
+	ticksPeriod = 0x10000
+)
+
+// keep in sync with enum trace_ev in ../nan-15_chord.c
+const (
+	trNone = iota
+	trIdle
+	trKey
+	trCommit
+	trEmit
+	trReport
+	trEEPROM
+	trLED
+)
+
+func describe(ev, arg int) string {
+	switch ev {
+	case trIdle:
+		return "idle"
+	case trKey:
+		action := "up"
+		if arg&0x80 != 0 {
+			action = "down"
+		}
+		return fmt.Sprintf("key %d,%d %s", arg>>4&7, arg&0xf, action)
+	case trCommit:
+		return fmt.Sprintf("commit %d%d%d%d", arg>>6&3, arg>>4&3, arg>>2&3, arg&3)
+	case trEmit:
+		return fmt.Sprintf("emit 0x%02x", arg)
+	case trReport:
+		return fmt.Sprintf("report 0x%02x", arg)
+	case trEEPROM:
+		return fmt.Sprintf("eeprom 0x%02x", arg)
+	case trLED:
+		state := "off"
+		if arg&0x80 != 0 {
+			state = "on"
+		}
+		return fmt.Sprintf("led %d %s", arg&0x7f, state)
+	}
+	return fmt.Sprintf("event %d 0x%02x", ev, arg)
+}
+
+func main() {
+	flag.Parse()
+	var inFile *os.File
+	var err error
+	if *inFilename == "-" {
+		inFile = os.Stdin
+	} else {
+		inFile, err = os.Open(*inFilename)
+		if err != nil {
+			log.Fatal(err)
+		}
+		defer inFile.Close()
+	}
+	var (
+		started        bool
+		prevTick, idle int
+		elapsed        int64
+	)
+	scanner := bufio.NewScanner(inFile)
+	if !*keyScript {
+		fmt.Printf("%12s %10s  %s\n", "ms", "+us", "event")
+	}
+	for scanner.Scan() {
+		m := recordRx.FindStringSubmatch(scanner.Text())
+		if m == nil {
+			continue
+		}
+		tick, _ := strconv.ParseInt(m[1], 16, 32)
+		ev, _ := strconv.ParseInt(m[2], 16, 32)
+		arg, _ := strconv.ParseInt(m[3], 16, 32)
+		var delta int
+		if started {
+			// after a TR_IDLE record of arg n, the firmware has
+			// skipped n-1 further half periods
+			skipped := 0
+			if idle > 0 {
+				skipped = (idle - 1) * halfPeriod
+			}
+			delta = skipped + ((int(tick)-prevTick-skipped)%ticksPeriod+ticksPeriod)%ticksPeriod
+		}
+		started = true
+		elapsed += int64(delta)
+		prevTick = int(tick)
+		idle = 0
+		if ev == trIdle {
+			idle = int(arg)
+		}
+		ms := float64(elapsed*usPerTick) / 1000
+		if !*keyScript {
+			fmt.Printf("%12.3f %10d  %s\n", ms, delta*usPerTick, describe(int(ev), int(arg)))
+		} else if ev == trKey {
+			action := "u"
+			if arg&0x80 != 0 {
+				action = "d"
+			}
+			// start after the firmware's boot LED flash
+			fmt.Printf("%.3f %s %d %d\n", ms+100, action, arg>>4&7, arg&0xf)
+		}
+	}
+	if err := scanner.Err(); err != nil {
+		log.Fatal(err)
+	}
+	if *keyScript {
+		fmt.Println("w 500")
+	}
+}